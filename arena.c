@@ -0,0 +1,229 @@
+/******************************************************************************/
+/*
+* @file   arena.c
+* @author Aditya Harsh
+* @brief  Bump allocator. Everything allocated from an arena is released
+*         together by one reset.
+*/
+/******************************************************************************/
+
+#include "arena.h"  /* arena interface      */
+#include <stdlib.h> /* malloc, free         */
+#include <stdint.h> /* uintptr_t            */
+
+/* alignment when none is asked for */
+#define ARENA_ALIGNMENT 16
+/* smallest block grabbed from malloc */
+#define ARENA_MIN_BLOCK 4096
+
+/**
+ * @brief A block of memory handed out front to back.
+ *
+ */
+typedef struct arena_block
+{
+    /* the next block (blocks past the current one are free) */
+    struct arena_block* next_;
+    /* the bytes in the block, and how many are handed out */
+    size_t capacity_;
+    size_t used_;
+} arena_block;
+
+/* the bytes of a block start right after its header */
+#define BLOCK_DATA(block) ((unsigned char*)((block) + 1))
+
+/**
+ * @brief Arena struct.
+ *
+ */
+struct arena
+{
+    /* every block, and the one being handed out from */
+    arena_block* first_;
+    arena_block* current_;
+    size_t block_size_;
+
+    /* bytes handed out since the last reset */
+    size_t used_;
+    /* the newest allocation, the only one that can change size */
+    unsigned char* last_;
+};
+
+/**
+ * @brief Bytes needed to align the next allocation in a block.
+ *
+ * @param block
+ * @param alignment
+ * @return size_t
+ */
+static size_t padding(const arena_block* block, size_t alignment)
+{
+    uintptr_t next = (uintptr_t)(BLOCK_DATA(block) + block->used_);
+
+    return (size_t)(-next & (alignment - 1));
+}
+
+/**
+ * @brief Creates an arena. No memory is taken until the first allocation.
+ *
+ * @param block_size
+ * @return arena*
+ */
+arena* arena_create(size_t block_size)
+{
+    /* allocate the data */
+    arena* a = malloc(sizeof(arena));
+
+    /* check if allocation succeeded */
+    if (a)
+    {
+        a->first_ = NULL;
+        a->current_ = NULL;
+        a->block_size_ = block_size > ARENA_MIN_BLOCK ? block_size : ARENA_MIN_BLOCK;
+        a->used_ = 0;
+        a->last_ = NULL;
+    }
+
+    return a;
+}
+
+/**
+ * @brief Frees an arena and its blocks.
+ *
+ * @param a
+ */
+void arena_destroy(arena** a)
+{
+    arena_block* block;
+    arena_block* next;
+
+    if (a && *a)
+    {
+        for (block = (*a)->first_; block; block = next)
+        {
+            next = block->next_;
+            free(block);
+        }
+
+        free(*a);
+        *a = NULL;
+    }
+}
+
+/**
+ * @brief Releases every allocation at once. Blocks are kept for reuse, later
+ *        ones are emptied as the arena reaches them.
+ *
+ * @param a
+ */
+void arena_reset(arena* a)
+{
+    if (!a) return;
+
+    a->current_ = a->first_;
+    if (a->current_)
+        a->current_->used_ = 0;
+
+    a->used_ = 0;
+    a->last_ = NULL;
+}
+
+/**
+ * @brief Allocates from the current block, moving on to the next one (or a
+ *        new one) when it's full.
+ *
+ * @param a
+ * @param bytes
+ * @param alignment (a power of two, 0 = 16)
+ * @return void* (NULL on failure)
+ */
+void* arena_alloc(arena* a, size_t bytes, size_t alignment)
+{
+    arena_block* block;
+    size_t pad = 0, capacity;
+
+    if (!a) return NULL;
+
+    if (!alignment) alignment = ARENA_ALIGNMENT;
+    if (alignment & (alignment - 1)) return NULL;
+
+    for (block = a->current_; block; block = block->next_)
+    {
+        if (block != a->current_)
+            block->used_ = 0;
+
+        pad = padding(block, alignment);
+        if (pad <= block->capacity_ - block->used_ && bytes <= block->capacity_ - block->used_ - pad)
+            break;
+    }
+
+    if (!block)
+    {
+        /* nothing left fits, add a block after the current one */
+        capacity = bytes + alignment > a->block_size_ ? bytes + alignment : a->block_size_;
+        if (capacity < bytes) return NULL;
+
+        block = malloc(sizeof(arena_block) + capacity);
+        if (!block) return NULL;
+
+        block->capacity_ = capacity;
+        block->used_ = 0;
+
+        if (a->current_)
+        {
+            block->next_ = a->current_->next_;
+            a->current_->next_ = block;
+        }
+        else
+        {
+            block->next_ = NULL;
+            a->first_ = block;
+        }
+
+        pad = padding(block, alignment);
+    }
+
+    a->current_ = block;
+    a->last_ = BLOCK_DATA(block) + block->used_ + pad;
+    block->used_ += pad + bytes;
+    a->used_ += pad + bytes;
+
+    return a->last_;
+}
+
+/**
+ * @brief Resizes the newest allocation without moving it.
+ *
+ * @param a
+ * @param data
+ * @param bytes
+ * @return true
+ * @return false (data isn't the newest allocation, or the block is full)
+ */
+bool arena_extend(arena* a, const void* data, size_t bytes)
+{
+    size_t offset;
+
+    if (!a || !data || data != a->last_) return false;
+
+    offset = (size_t)(a->last_ - BLOCK_DATA(a->current_));
+    if (bytes > a->current_->capacity_ - offset) return false;
+
+    a->used_ = a->used_ - (a->current_->used_ - offset) + bytes;
+    a->current_->used_ = offset + bytes;
+
+    return true;
+}
+
+/**
+ * @brief Returns the number of bytes handed out since the last reset.
+ *
+ * @param a
+ * @return size_t
+ */
+size_t arena_used(const arena* a)
+{
+    if (!a) return 0;
+
+    return a->used_;
+}
@@ -0,0 +1,33 @@
+/******************************************************************************/
+/*
+* @file   arena.h
+* @author Aditya Harsh
+* @brief  Bump allocator. Everything allocated from an arena is released
+*         together by one reset.
+*/
+/******************************************************************************/
+
+#pragma once
+
+#include <stddef.h> /* size_t */
+
+/* define boolean values */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+/* opaque struct pointer */
+typedef struct arena arena;
+
+/* creates an arena that grabs memory in blocks of at least block_size bytes */
+arena* arena_create(size_t block_size);
+/* frees an arena and every block it holds */
+void arena_destroy(arena** a);
+/* releases everything allocated from the arena, keeping its blocks */
+void arena_reset(arena* a);
+/* allocates bytes aligned to alignment (a power of two, 0 = 16) */
+void* arena_alloc(arena* a, size_t bytes, size_t alignment);
+/* grows or shrinks the newest allocation in place, returns whether it could */
+bool arena_extend(arena* a, const void* data, size_t bytes);
+/* returns the number of bytes handed out since the last reset */
+size_t arena_used(const arena* a);
@@ -0,0 +1,332 @@
+/******************************************************************************/
+/*
+* @file   bvector.c
+* @author Aditya Harsh
+* @brief  Blob vector. Variable length byte strings packed back to back in
+*         one buffer, found through an array of offsets.
+*/
+/******************************************************************************/
+
+#include "bvector.h" /* blob vector interface   */
+#include <stdlib.h>  /* malloc, realloc, free   */
+#include <string.h>  /* memcpy, memmove         */
+#include <stdint.h>  /* SIZE_MAX, uintptr_t     */
+
+/* default number of blobs */
+#define DEFAULT_CAPACITY 16
+/* default bytes for the blobs */
+#define DEFAULT_BYTES 256
+/* erased bytes left alone until there are this many */
+#define COMPACT_MIN 4096
+
+/**
+ * @brief Where a blob is in the buffer.
+ *
+ */
+typedef struct
+{
+    size_t offset_;
+    size_t length_;
+} bvector_entry;
+
+/**
+ * @brief Blob vector struct.
+ *
+ */
+struct bvector
+{
+    /* one entry per blob, in order (offsets only ever increase) */
+    bvector_entry* entries_;
+    size_t size_;
+    size_t capacity_;
+
+    /* the blobs, back to back, with erased ones still in between */
+    unsigned char* bytes_;
+    size_t used_;
+    size_t bytes_capacity_;
+    /* bytes of erased blobs not given back yet */
+    size_t dead_;
+};
+
+/**
+ * @brief Allocates a blob vector.
+ *
+ * @param capacity (0 = default)
+ * @param bytes (0 = default)
+ * @return bvector*
+ */
+bvector* alloc_bvector(size_t capacity, size_t bytes)
+{
+    /* allocate the data */
+    bvector* vec = malloc(sizeof(bvector));
+
+    /* check if allocation succeeded */
+    if (vec)
+    {
+        vec->capacity_ = capacity ? capacity : DEFAULT_CAPACITY;
+        vec->bytes_capacity_ = bytes ? bytes : DEFAULT_BYTES;
+
+        vec->entries_ = vec->capacity_ <= SIZE_MAX / sizeof(bvector_entry)
+                      ? malloc(vec->capacity_ * sizeof(bvector_entry)) : NULL;
+        vec->bytes_ = malloc(vec->bytes_capacity_);
+
+        /* check for successful allocation */
+        if (!vec->entries_ || !vec->bytes_)
+        {
+            free(vec->entries_);
+            free(vec->bytes_);
+            free(vec);
+            return NULL;
+        }
+
+        /* set values */
+        vec->size_ = 0;
+        vec->used_ = 0;
+        vec->dead_ = 0;
+    }
+
+    return vec;
+}
+
+/**
+ * @brief Frees allocated memory.
+ *
+ * @param vec
+ */
+void free_bvector(bvector** vec)
+{
+    if (vec && *vec)
+    {
+        free((*vec)->entries_);
+        free((*vec)->bytes_);
+        free(*vec);
+        *vec = NULL;
+    }
+}
+
+/**
+ * @brief Moves the blobs together, dropping the bytes of erased ones. The
+ *        offsets only increase, so everything moves towards the front.
+ *
+ * @param vec
+ */
+void bvector_compact(bvector* vec)
+{
+    /* iterator */
+    size_t i;
+    size_t used = 0;
+
+    if (!vec || !vec->dead_) return;
+
+    for (i = 0; i < vec->size_; ++i)
+    {
+        if (vec->entries_[i].offset_ != used)
+            memmove(vec->bytes_ + used, vec->bytes_ + vec->entries_[i].offset_,
+                    vec->entries_[i].length_);
+
+        vec->entries_[i].offset_ = used;
+        used += vec->entries_[i].length_;
+    }
+
+    vec->used_ = used;
+    vec->dead_ = 0;
+}
+
+/**
+ * @brief Makes sure length more bytes fit. Erased bytes are reclaimed
+ *        first if they're at least half the buffer, otherwise it doubles.
+ *
+ * @param vec
+ * @param length
+ * @param pinned (don't compact, the caller holds a pointer into the buffer)
+ * @return true
+ * @return false
+ */
+static bool make_room(bvector* vec, size_t length, bool pinned)
+{
+    size_t capacity;
+    unsigned char* temp;
+
+    if (length <= vec->bytes_capacity_ - vec->used_) return true;
+
+    if (!pinned && vec->dead_ >= vec->used_ / 2)
+    {
+        bvector_compact(vec);
+        if (length <= vec->bytes_capacity_ - vec->used_) return true;
+    }
+
+    if (length > SIZE_MAX - vec->used_) return false;
+
+    capacity = vec->bytes_capacity_ <= SIZE_MAX / 2 ? vec->bytes_capacity_ * 2 : SIZE_MAX;
+    if (capacity < vec->used_ + length)
+        capacity = vec->used_ + length;
+
+    temp = realloc(vec->bytes_, capacity);
+    if (!temp) return false;
+
+    vec->bytes_ = temp;
+    vec->bytes_capacity_ = capacity;
+
+    return true;
+}
+
+/**
+ * @brief Appends a copy of a blob. The blob may come from the vector itself.
+ *
+ * @param vec
+ * @param data (may be NULL when length is 0)
+ * @param length
+ * @return true
+ * @return false
+ */
+bool bvector_push(bvector* vec, const void* data, size_t length)
+{
+    bvector_entry* temp;
+    uintptr_t address = (uintptr_t)data, base;
+    bool inside;
+
+    if (!vec || (!data && length)) return false;
+
+    base = (uintptr_t)vec->bytes_;
+    inside = address >= base && address < base + vec->bytes_capacity_;
+
+    if (vec->size_ == vec->capacity_)
+    {
+        if (vec->capacity_ > SIZE_MAX / sizeof(bvector_entry) / 2) return false;
+
+        temp = realloc(vec->entries_, vec->capacity_ * 2 * sizeof(bvector_entry));
+        if (!temp) return false;
+
+        vec->entries_ = temp;
+        vec->capacity_ *= 2;
+    }
+
+    if (!make_room(vec, length, inside)) return false;
+
+    /* the buffer may have moved under data */
+    if (inside)
+        data = vec->bytes_ + (address - base);
+
+    if (length)
+        memcpy(vec->bytes_ + vec->used_, data, length);
+
+    vec->entries_[vec->size_].offset_ = vec->used_;
+    vec->entries_[vec->size_].length_ = length;
+    ++vec->size_;
+    vec->used_ += length;
+
+    return true;
+}
+
+/**
+ * @brief Gets a blob.
+ *
+ * @param vec
+ * @param index
+ * @param length (receives the length, may be NULL)
+ * @return void* (NULL if index is out of range)
+ */
+void* bvector_get(const bvector* vec, size_t index, size_t* length)
+{
+    if (!vec || index >= vec->size_) return NULL;
+
+    if (length) *length = vec->entries_[index].length_;
+
+    return vec->bytes_ + vec->entries_[index].offset_;
+}
+
+/**
+ * @brief Removes a blob. Only the offsets move; its bytes stay where they
+ *        are until erased bytes outweigh the live ones (or the buffer needs
+ *        the room), then everything is compacted at once.
+ *
+ * @param vec
+ * @param index
+ */
+void bvector_erase(bvector* vec, size_t index)
+{
+    bvector_entry entry;
+
+    if (!vec || index >= vec->size_) return;
+
+    entry = vec->entries_[index];
+
+    memmove(vec->entries_ + index, vec->entries_ + index + 1,
+            (vec->size_ - index - 1) * sizeof(bvector_entry));
+    --vec->size_;
+
+    /* the last bytes in the buffer can be given back straight away */
+    if (entry.offset_ + entry.length_ == vec->used_)
+        vec->used_ = entry.offset_;
+    else
+        vec->dead_ += entry.length_;
+
+    if (!vec->size_)
+    {
+        vec->used_ = 0;
+        vec->dead_ = 0;
+    }
+    else if (vec->dead_ >= COMPACT_MIN && vec->dead_ > vec->used_ - vec->dead_)
+    {
+        bvector_compact(vec);
+    }
+}
+
+/**
+ * @brief Removes every blob, keeping the memory.
+ *
+ * @param vec
+ */
+void clear_bvector(bvector* vec)
+{
+    if (!vec) return;
+
+    vec->size_ = 0;
+    vec->used_ = 0;
+    vec->dead_ = 0;
+}
+
+/**
+ * @brief Calls func on each blob in order, until it returns false.
+ *
+ * @param vec
+ * @param func
+ * @param context (passed to func)
+ */
+void bvector_foreach(const bvector* vec, BLOBFUNC func, void* context)
+{
+    /* iterator */
+    size_t i;
+
+    if (!vec || !func) return;
+
+    for (i = 0; i < vec->size_; ++i)
+        if (!func(vec->bytes_ + vec->entries_[i].offset_, vec->entries_[i].length_, context))
+            return;
+}
+
+/**
+ * @brief Returns the number of blobs.
+ *
+ * @param vec
+ * @return size_t
+ */
+size_t bvector_size(const bvector* vec)
+{
+    if (!vec) return 0;
+
+    return vec->size_;
+}
+
+/**
+ * @brief Returns the bytes held by the blobs, not counting erased ones.
+ *
+ * @param vec
+ * @return size_t
+ */
+size_t bvector_bytes(const bvector* vec)
+{
+    if (!vec) return 0;
+
+    return vec->used_ - vec->dead_;
+}
@@ -0,0 +1,43 @@
+/******************************************************************************/
+/*
+* @file   bvector.h
+* @author Aditya Harsh
+* @brief  Blob vector. Variable length byte strings packed back to back in
+*         one buffer, found through an array of offsets.
+*/
+/******************************************************************************/
+
+#pragma once
+
+#include <stddef.h> /* size_t */
+
+/* define boolean values */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+/* opaque struct pointer */
+typedef struct bvector bvector;
+/* called on each blob in order, returning false stops the walk */
+typedef bool (*BLOBFUNC)(const void* data, size_t length, void* context);
+
+/* allocates a blob vector with room for capacity blobs and bytes bytes */
+bvector* alloc_bvector(size_t capacity, size_t bytes);
+/* frees a blob vector */
+void free_bvector(bvector** vec);
+/* appends a copy of length bytes (data may be NULL when length is 0) */
+bool bvector_push(bvector* vec, const void* data, size_t length);
+/* gets a blob and its length, valid until the next push, erase or compact */
+void* bvector_get(const bvector* vec, size_t index, size_t* length);
+/* removes a blob, its bytes are reclaimed later */
+void bvector_erase(bvector* vec, size_t index);
+/* moves the blobs together, dropping the bytes of erased ones */
+void bvector_compact(bvector* vec);
+/* removes every blob */
+void clear_bvector(bvector* vec);
+/* calls func on each blob in order */
+void bvector_foreach(const bvector* vec, BLOBFUNC func, void* context);
+/* returns the number of blobs */
+size_t bvector_size(const bvector* vec);
+/* returns the bytes held by the blobs (not counting erased ones) */
+size_t bvector_bytes(const bvector* vec);
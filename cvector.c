@@ -0,0 +1,319 @@
+/******************************************************************************/
+/*
+* @file   cvector.c
+* @author Aditya Harsh
+* @brief  Concurrent append-only vector. Any number of threads push at once,
+*         elements never move once they're in. Written in C11.
+*/
+/******************************************************************************/
+
+#include "cvector.h"   /* concurrent vector interface */
+#include <stdlib.h>    /* malloc, calloc, free        */
+#include <string.h>    /* memcpy                      */
+#include <limits.h>    /* UINT_MAX, CHAR_BIT          */
+#include <stdint.h>    /* SIZE_MAX                    */
+#include <stdatomic.h> /* _Atomic, atomic_*           */
+
+/* smallest first segment */
+#define CVECTOR_MIN_SEGMENT 16
+/* every segment doubles, so this many cover every unsigned index */
+#define CVECTOR_SEGMENTS (sizeof(unsigned) * CHAR_BIT)
+
+/* slot states */
+#define SLOT_EMPTY 0
+#define SLOT_PUBLISHED 1
+
+/**
+ * @brief Concurrent vector struct.
+ *
+ */
+struct cvector
+{
+    /* slots handed out, each push takes the next one */
+    atomic_uint reserved_;
+    /* every slot below this is known to be published (only ever grows) */
+    atomic_uint published_;
+    /* the size of the data */
+    unsigned data_size_;
+
+    /* segment k holds (1 << (shift_ + k)) elements, then one state byte
+       per element, and is never reallocated */
+    unsigned shift_;
+    _Atomic(unsigned char*) segments_[CVECTOR_SEGMENTS];
+};
+
+/**
+ * @brief Returns the index of the highest set bit.
+ *
+ * @param x (not 0)
+ * @return unsigned
+ */
+static unsigned top_bit(unsigned x)
+{
+#ifdef __GNUC__
+    return (unsigned)(sizeof(unsigned) * CHAR_BIT - 1) - (unsigned)__builtin_clz(x);
+#else
+    unsigned bit = 0;
+
+    while (x >>= 1)
+        ++bit;
+
+    return bit;
+#endif
+}
+
+/**
+ * @brief Finds the segment and offset of an index.
+ *
+ * @param vec
+ * @param index
+ * @param offset
+ * @return unsigned (the segment)
+ */
+static unsigned locate(const cvector* vec, unsigned index, unsigned* offset)
+{
+    unsigned j = index + (1u << vec->shift_);
+    unsigned top = top_bit(j);
+
+    *offset = j - (1u << top);
+
+    return top - vec->shift_;
+}
+
+/**
+ * @brief Returns the number of elements in a segment.
+ *
+ * @param vec
+ * @param segment
+ * @return unsigned
+ */
+static unsigned segment_length(const cvector* vec, unsigned segment)
+{
+    return 1u << (vec->shift_ + segment);
+}
+
+/**
+ * @brief Returns the state bytes of a segment.
+ *
+ * @param vec
+ * @param data
+ * @param segment
+ * @return atomic_uchar*
+ */
+static atomic_uchar* segment_states(const cvector* vec, unsigned char* data, unsigned segment)
+{
+    return (atomic_uchar*)(data + (size_t)segment_length(vec, segment) * vec->data_size_);
+}
+
+/**
+ * @brief Gets a segment, allocating it if nobody has yet. Threads racing
+ *        to allocate the same segment agree on one with a CAS.
+ *
+ * @param vec
+ * @param segment
+ * @return unsigned char* (NULL on failure)
+ */
+static unsigned char* get_segment(cvector* vec, unsigned segment)
+{
+    unsigned char* data = atomic_load_explicit(&vec->segments_[segment], memory_order_acquire);
+    unsigned char* expected = NULL;
+    size_t length;
+
+    if (data) return data;
+
+    length = segment_length(vec, segment);
+    if (length > SIZE_MAX / (vec->data_size_ + sizeof(atomic_uchar))) return NULL;
+
+    /* zeroed, so every state starts out SLOT_EMPTY */
+    data = calloc(length, vec->data_size_ + sizeof(atomic_uchar));
+    if (!data) return NULL;
+
+    if (!atomic_compare_exchange_strong_explicit(&vec->segments_[segment], &expected, data,
+                                                 memory_order_acq_rel, memory_order_acquire))
+    {
+        /* somebody beat us to it */
+        free(data);
+        data = expected;
+    }
+
+    return data;
+}
+
+/**
+ * @brief Allocates a concurrent vector.
+ *
+ * @param capacity (rounded up to a power of two)
+ * @param data_size
+ * @return cvector*
+ */
+cvector* alloc_cvector(unsigned capacity, unsigned data_size)
+{
+    /* iterator */
+    unsigned i;
+
+    /* allocate the data */
+    cvector* vec;
+
+    if (!data_size) return NULL;
+
+    vec = malloc(sizeof(cvector));
+
+    /* check if allocation succeeded */
+    if (vec)
+    {
+        /* set values */
+        atomic_init(&vec->reserved_, 0);
+        atomic_init(&vec->published_, 0);
+        vec->data_size_ = data_size;
+
+        if (capacity < CVECTOR_MIN_SEGMENT)
+            capacity = CVECTOR_MIN_SEGMENT;
+        if (capacity > UINT_MAX / 2 + 1)
+            capacity = UINT_MAX / 2 + 1;
+        vec->shift_ = top_bit(capacity - 1) + 1;
+
+        for (i = 0; i < CVECTOR_SEGMENTS; ++i)
+            atomic_init(&vec->segments_[i], NULL);
+
+        /* the first segment is always needed */
+        if (!get_segment(vec, 0))
+        {
+            free(vec);
+            return NULL;
+        }
+    }
+
+    return vec;
+}
+
+/**
+ * @brief Frees allocated memory.
+ *
+ * @param vec
+ */
+void free_cvector(cvector** vec)
+{
+    /* iterator */
+    unsigned i;
+
+    if (vec && *vec)
+    {
+        for (i = 0; i < CVECTOR_SEGMENTS; ++i)
+            free(atomic_load_explicit(&(*vec)->segments_[i], memory_order_relaxed));
+
+        free(*vec);
+        *vec = NULL;
+    }
+}
+
+/**
+ * @brief Pushes back. Takes a slot with a CAS on the slot count, copies
+ *        into it and publishes it; pushes never wait on each other. The
+ *        slot's segment is allocated before the slot is taken, and a full
+ *        vector is checked before, so a failed push takes nothing: the
+ *        count never runs past what's stored (or wraps), and no slot is
+ *        left unpublished.
+ *
+ * @param vec
+ * @param data
+ * @param index (receives the slot, may be NULL)
+ * @return true
+ * @return false (the vector is full, or a segment couldn't be allocated)
+ */
+bool cvector_push_back(cvector* vec, const void* data, unsigned* index)
+{
+    unsigned slot, segment, offset;
+    unsigned char* memory;
+
+    if (!vec || !data) return false;
+
+    slot = atomic_load_explicit(&vec->reserved_, memory_order_relaxed);
+
+    do
+    {
+        /* past the last segment */
+        if (slot > UINT_MAX - (1u << vec->shift_)) return false;
+
+        segment = locate(vec, slot, &offset);
+        memory = get_segment(vec, segment);
+        if (!memory) return false;
+    }
+    while (!atomic_compare_exchange_weak_explicit(&vec->reserved_, &slot, slot + 1,
+                                                  memory_order_relaxed, memory_order_relaxed));
+
+    memcpy(memory + (size_t)offset * vec->data_size_, data, vec->data_size_);
+
+    /* whoever sees the state also sees the element */
+    atomic_store_explicit(segment_states(vec, memory, segment) + offset, SLOT_PUBLISHED,
+                          memory_order_release);
+
+    if (index) *index = slot;
+
+    return true;
+}
+
+/**
+ * @brief Gets an element. The pointer stays valid until the vector is freed.
+ *
+ * @param vec
+ * @param index
+ * @return void* (NULL if it isn't published yet)
+ */
+void* cvector_get(const cvector* vec, unsigned index)
+{
+    unsigned segment, offset;
+    unsigned char* memory;
+
+    if (!vec || index >= atomic_load_explicit(&vec->reserved_, memory_order_relaxed)) return NULL;
+    if (index > UINT_MAX - (1u << vec->shift_)) return NULL;
+
+    segment = locate(vec, index, &offset);
+    memory = atomic_load_explicit(&vec->segments_[segment], memory_order_acquire);
+    if (!memory) return NULL;
+
+    if (atomic_load_explicit(segment_states(vec, memory, segment) + offset, memory_order_acquire)
+        != SLOT_PUBLISHED)
+        return NULL;
+
+    return memory + (size_t)offset * vec->data_size_;
+}
+
+/**
+ * @brief Returns the number of slots handed out.
+ *
+ * @param vec
+ * @return unsigned
+ */
+unsigned cvector_size(const cvector* vec)
+{
+    if (!vec) return 0;
+
+    return atomic_load_explicit(&vec->reserved_, memory_order_relaxed);
+}
+
+/**
+ * @brief Returns how many elements from the front are published. Every index
+ *        below it can be read without checking. Picks up where the last call
+ *        (from any thread) stopped.
+ *
+ * @param vec
+ * @return unsigned
+ */
+unsigned cvector_published(cvector* vec)
+{
+    unsigned published, known;
+
+    if (!vec) return 0;
+
+    known = published = atomic_load_explicit(&vec->published_, memory_order_acquire);
+
+    while (cvector_get(vec, published))
+        ++published;
+
+    /* move the shared mark forward, unless another reader got further */
+    while (known < published &&
+           !atomic_compare_exchange_weak_explicit(&vec->published_, &known, published,
+                                                  memory_order_release, memory_order_acquire));
+
+    return published;
+}
@@ -0,0 +1,31 @@
+/******************************************************************************/
+/*
+* @file   cvector.h
+* @author Aditya Harsh
+* @brief  Concurrent append-only vector. Any number of threads push at once,
+*         elements never move once they're in. Written in C11.
+*/
+/******************************************************************************/
+
+#pragma once
+
+/* define boolean values */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+/* opaque struct pointer */
+typedef struct cvector cvector;
+
+/* allocates a concurrent vector, the first segment holds capacity elements */
+cvector* alloc_cvector(unsigned capacity, unsigned data_size);
+/* frees a concurrent vector (no other thread may still be using it) */
+void free_cvector(cvector** vec);
+/* pushes back from any thread, index receives the element's slot (may be NULL) */
+bool cvector_push_back(cvector* vec, const void* data, unsigned* index);
+/* gets a published element, NULL if it hasn't been published yet */
+void* cvector_get(const cvector* vec, unsigned index);
+/* returns the number of slots handed out (some may not be published yet) */
+unsigned cvector_size(const cvector* vec);
+/* returns how many elements from the front are published, all readable */
+unsigned cvector_published(cvector* vec);
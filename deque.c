@@ -0,0 +1,423 @@
+/******************************************************************************/
+/*
+* @file   deque.c
+* @author Aditya Harsh
+* @brief  Ring buffer deque. Pushes and pops on both ends in O(1).
+*/
+/******************************************************************************/
+
+#include "deque.h"    /* deque interface */
+#include <stdlib.h>   /* malloc, realloc, free */
+#include <stdio.h>    /* printf */
+#include <string.h>   /* memcpy, memmove, strcpy, strcmp */
+#include <stdint.h>   /* SIZE_MAX */
+#include <limits.h>   /* UINT_MAX */
+
+/* default capacity is set to two */
+#define DEFAULT_CAPACITY 2
+
+/**
+ * @brief Deque struct.
+ *
+ */
+struct deque
+{
+    /* the number of elements */
+    unsigned size_;
+    /* the max number of elements */
+    unsigned capacity_;
+    /* the size of the data */
+    unsigned data_size_;
+    /* the slot holding the first element */
+    unsigned head_;
+
+    /* holds the type of data */
+    char* data_type_;
+    DEQUEPRINTFUNC pf_;
+
+    /* the elements, wrapping around the end of the buffer */
+    unsigned char* data_;
+};
+
+/**
+ * @brief Gets the slot of the element at an index.
+ *
+ * @param dq
+ * @param index
+ * @return unsigned char*
+ */
+static unsigned char* slot(const deque* dq, unsigned index)
+{
+    unsigned i = dq->head_ + index;
+
+    if (i >= dq->capacity_)
+        i -= dq->capacity_;
+
+    return dq->data_ + (size_t)i * dq->data_size_;
+}
+
+/**
+ * @brief Checks the bytes for capacity elements fit in a size_t.
+ *
+ * @param capacity
+ * @param data_size
+ * @return true
+ * @return false
+ */
+static bool fits(unsigned capacity, unsigned data_size)
+{
+    return !data_size || capacity <= SIZE_MAX / data_size;
+}
+
+/**
+ * @brief Makes room for one more element, doubling the capacity in place
+ *        and keeping the elements in order. data may point into the deque,
+ *        it's returned relocated.
+ *
+ * @param dq
+ * @param data
+ * @return const void* (NULL on failure, or if the capacity can't double)
+ */
+static const void* grow(deque* dq, const void* data)
+{
+    unsigned char* temp;
+    const unsigned char* bytes = data;
+    unsigned capacity, wrapped, index = 0;
+    size_t within = 0;
+    bool inside;
+
+    if (dq->size_ < dq->capacity_) return data;
+
+    /* doubling would wrap (and realloc would shrink the buffer) */
+    if (dq->capacity_ > UINT_MAX / 2) return NULL;
+
+    /* the data being pushed may be one of our own elements */
+    inside = dq->data_ && bytes >= dq->data_ &&
+             bytes < dq->data_ + (size_t)dq->capacity_ * dq->data_size_;
+
+    if (inside)
+    {
+        index = (unsigned)((size_t)(bytes - dq->data_) / dq->data_size_);
+        within = (size_t)(bytes - dq->data_) % dq->data_size_;
+        index = index >= dq->head_ ? index - dq->head_ : index + dq->capacity_ - dq->head_;
+    }
+
+    capacity = dq->capacity_ ? dq->capacity_ * 2 : DEFAULT_CAPACITY;
+    if (!fits(capacity, dq->data_size_)) return NULL;
+
+    temp = realloc(dq->data_, (size_t)capacity * dq->data_size_);
+    if (!temp) return NULL;
+
+    /* the deque is full, so slots [0, head_) hold the wrapped around back */
+    wrapped = dq->head_;
+
+    if (wrapped <= dq->capacity_ - wrapped)
+    {
+        /* move the wrapped part past the old end */
+        memcpy(temp + (size_t)dq->capacity_ * dq->data_size_, temp, (size_t)wrapped * dq->data_size_);
+    }
+    else
+    {
+        /* move the front part to the new end */
+        memcpy(temp + (size_t)(capacity - dq->capacity_ + wrapped) * dq->data_size_,
+               temp + (size_t)wrapped * dq->data_size_,
+               (size_t)(dq->capacity_ - wrapped) * dq->data_size_);
+        dq->head_ = capacity - dq->capacity_ + wrapped;
+    }
+
+    dq->data_ = temp;
+    dq->capacity_ = capacity;
+
+    return inside ? slot(dq, index) + within : data;
+}
+
+/**
+ * @brief Allocates a deque of any type of elements.
+ *
+ * @param capacity
+ * @param data_size
+ * @param data_type
+ * @param func
+ */
+deque* alloc_deque(unsigned capacity, unsigned data_size, const char* data_type, DEQUEPRINTFUNC func)
+{
+    /* allocate the data */
+    deque* dq = malloc(sizeof(deque));
+
+    /* check if allocation succeeded */
+    if (dq)
+    {
+        /* allocate memory (0 = default capacity) */
+        dq->capacity_ = capacity ? capacity : DEFAULT_CAPACITY;
+        dq->data_ = fits(dq->capacity_, data_size) ? malloc((size_t)dq->capacity_ * data_size)
+                                                   : NULL;
+
+        /* check for successful allocation */
+        if (!dq->data_)
+        {
+            free(dq);
+            return NULL;
+        }
+
+        /* store the name of the type */
+        dq->data_type_ = malloc(sizeof(char) * (strlen(data_type) + 1));
+
+        /* free allocated memory */
+        if (!dq->data_type_)
+        {
+            free(dq->data_);
+            free(dq);
+            return NULL;
+        }
+
+        /* set values */
+        strcpy(dq->data_type_, data_type);
+        dq->size_ = 0;
+        dq->head_ = 0;
+        dq->data_size_ = data_size;
+        dq->pf_ = func;
+
+        return dq;
+    }
+
+    /* failure */
+    return NULL;
+}
+
+/**
+ * @brief Frees allocated memory.
+ *
+ * @param dq
+ */
+void free_deque(deque** dq)
+{
+    if (dq && *dq)
+    {
+        free((*dq)->data_);
+        free((*dq)->data_type_);
+        free(*dq);
+        *dq = NULL;
+    }
+}
+
+/**
+ * @brief Pushes back.
+ *
+ * @param dq
+ * @param data
+ */
+void deque_push_back(deque* dq, const void* data)
+{
+    if (!dq || !data) return;
+
+    data = grow(dq, data);
+    if (!data) return;
+
+    memcpy(slot(dq, dq->size_), data, dq->data_size_);
+    ++dq->size_;
+}
+
+/**
+ * @brief Pushes front.
+ *
+ * @param dq
+ * @param data
+ */
+void deque_push_front(deque* dq, const void* data)
+{
+    if (!dq || !data) return;
+
+    data = grow(dq, data);
+    if (!data) return;
+
+    dq->head_ = dq->head_ ? dq->head_ - 1 : dq->capacity_ - 1;
+    memcpy(slot(dq, 0), data, dq->data_size_);
+    ++dq->size_;
+}
+
+/**
+ * @brief Removes the last element.
+ *
+ * @param dq
+ */
+void deque_pop_back(deque* dq)
+{
+    if (!dq || !dq->size_) return;
+
+    --dq->size_;
+}
+
+/**
+ * @brief Removes the first element.
+ *
+ * @param dq
+ */
+void deque_pop_front(deque* dq)
+{
+    if (!dq || !dq->size_) return;
+
+    if (++dq->head_ == dq->capacity_)
+        dq->head_ = 0;
+
+    --dq->size_;
+}
+
+/**
+ * @brief "Clears" a deque.
+ *
+ * @param dq
+ */
+void clear_deque(deque* dq)
+{
+    if (!dq) return;
+
+    dq->size_ = 0;
+    dq->head_ = 0;
+}
+
+/**
+ * @brief Returns whether or not a deque is empty.
+ *
+ * @param dq
+ * @return true
+ * @return false
+ */
+bool deque_empty(const deque* dq)
+{
+    if (!dq) return true;
+
+    return dq->size_ ? false : true;
+}
+
+/**
+ * @brief Returns the size of a deque.
+ *
+ * @param dq
+ * @return unsigned
+ */
+unsigned deque_size(const deque* dq)
+{
+    if (!dq) return 0;
+
+    return dq->size_;
+}
+
+/**
+ * @brief Returns the capacity of a deque.
+ *
+ * @param dq
+ * @return unsigned
+ */
+unsigned deque_capacity(const deque* dq)
+{
+    if (!dq) return 0;
+
+    return dq->capacity_;
+}
+
+/**
+ * @brief Removes an element, shifting whichever side of it is shorter.
+ *
+ * @param dq
+ * @param index
+ */
+void deque_remove_element(deque* dq, unsigned index)
+{
+    /* iterator variable */
+    unsigned i;
+
+    /* safety checking */
+    if (!dq || index >= dq->size_) return;
+
+    if (index < dq->size_ / 2)
+    {
+        for (i = index; i > 0; --i)
+            memcpy(slot(dq, i), slot(dq, i - 1), dq->data_size_);
+
+        deque_pop_front(dq);
+    }
+    else
+    {
+        for (i = index; i + 1 < dq->size_; ++i)
+            memcpy(slot(dq, i), slot(dq, i + 1), dq->data_size_);
+
+        deque_pop_back(dq);
+    }
+}
+
+/**
+ * @brief Gets a requested value. The pointer is valid until the deque grows.
+ *
+ * @param dq
+ * @param index
+ * @return void*
+ */
+void* deque_get(const deque* dq, unsigned index)
+{
+    if (!dq || index >= dq->size_) return NULL;
+
+    return slot(dq, index);
+}
+
+/**
+ * @brief Gets the first element.
+ *
+ * @param dq
+ * @return void*
+ */
+void* deque_front(const deque* dq)
+{
+    return deque_get(dq, 0);
+}
+
+/**
+ * @brief Gets the last element.
+ *
+ * @param dq
+ * @return void*
+ */
+void* deque_back(const deque* dq)
+{
+    if (!dq || !dq->size_) return NULL;
+
+    return slot(dq, dq->size_ - 1);
+}
+
+/**
+ * @brief Prints the type of data held within the deque.
+ *
+ * @param dq
+ */
+void print_deque_type(const deque* dq)
+{
+    if (!dq) return;
+    printf("%s\n", dq->data_type_);
+}
+
+/**
+ * @brief Dumps the contents of a deque.
+ *
+ * @param dq
+ */
+void dump_deque(const deque* dq)
+{
+    if (!dq || !dq->pf_) return;
+
+    /* execute print function */
+    dq->pf_(dq);
+}
+
+/**
+ * @brief Checks a type of the deque.
+ *
+ * @param dq
+ * @param type
+ * @return true
+ * @return false
+ */
+bool check_deque_type(const deque* dq, const char* type)
+{
+    if (!dq || !type) return false;
+
+    return (!strcmp(dq->data_type_, type));
+}
@@ -0,0 +1,54 @@
+/******************************************************************************/
+/*
+* @file   deque.h
+* @author Aditya Harsh
+* @brief  Ring buffer deque. Pushes and pops on both ends in O(1).
+*/
+/******************************************************************************/
+
+#pragma once
+
+/* define boolean values */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+/* opaque struct pointer */
+typedef struct deque deque;
+/* typedef for printing function */
+typedef void (*DEQUEPRINTFUNC)(const deque*);
+
+/* allocates a deque */
+deque* alloc_deque(unsigned capacity, unsigned data_size, const char* data_type, DEQUEPRINTFUNC func);
+/* frees a deque */
+void free_deque(deque** dq);
+/* pushes back into a deque */
+void deque_push_back(deque* dq, const void* data);
+/* pushes onto the front of a deque */
+void deque_push_front(deque* dq, const void* data);
+/* pops the back of a deque */
+void deque_pop_back(deque* dq);
+/* pops the front of a deque */
+void deque_pop_front(deque* dq);
+/* clears a deque */
+void clear_deque(deque* dq);
+/* returns whether or not the deque is empty */
+bool deque_empty(const deque* dq);
+/* returns the size of the deque */
+unsigned deque_size(const deque* dq);
+/* returns the capacity of the deque */
+unsigned deque_capacity(const deque* dq);
+/* removes an element at an index */
+void deque_remove_element(deque* dq, unsigned index);
+/* gets an element */
+void* deque_get(const deque* dq, unsigned index);
+/* gets the first element */
+void* deque_front(const deque* dq);
+/* gets the last element */
+void* deque_back(const deque* dq);
+/* prints the data type of a deque */
+void print_deque_type(const deque* dq);
+/* dumps the contents of a deque */
+void dump_deque(const deque* dq);
+/* checks the type of the deque */
+bool check_deque_type(const deque* dq, const char* type);
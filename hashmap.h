@@ -0,0 +1,359 @@
+/******************************************************************************/
+/*
+* @file   hashmap.h
+* @author Aditya Harsh
+* @brief  Type-agnostic open-addressing hash map. Written in ANSI-C.
+*/
+/******************************************************************************/
+
+/* HOW TO USE
+- Place init_hashmap(key type, value type) on top your file
+- Keys that can't be hashed bytewise or compared with == (structs, strings)
+  use init_hashmap_custom(key type, value type, hash, equal) instead, where
+  hash takes a const key* and equal takes two const key*. Both may be macros,
+  so they get inlined into the generated lookup.
+- Use the uniform functions to on the bottom of the file
+- Growing the table moves the entries over a few buckets at a time on each
+  put/erase, so no single insert pays for rehashing the whole map.
+
+    EXAMPLE:
+        #include "hashmap.h"
+
+        init_hashmap(int, float)
+
+        int main(void)
+        {
+            hashmap(int, float) my_map = create_hashmap(int, float);
+            float* value;
+
+            put_hashmap(int, float, my_map, 1, 2.5f);
+            put_hashmap(int, float, my_map, 7, 3.0f);
+            value = get_hashmap(int, float, my_map, 7);
+            erase_hashmap(int, float, my_map, 1);
+
+            clear_hashmap(int, float, my_map);
+
+            return 0;
+        }
+ */
+
+#pragma once
+
+#include <stdlib.h> /* malloc, calloc, free, NULL, size_t */
+
+/* macro helper functions */
+#define PASTE(x, y) x ## _ ## y
+#define EVALUATE(x, y) PASTE(x, y)
+
+/* define map, table and entry */
+#define hashmap(key, value) EVALUATE(EVALUATE(hashmap,key),value)
+#define h_table(key, value) EVALUATE(EVALUATE(h_table,key),value)
+#define h_entry(key, value) EVALUATE(EVALUATE(h_entry,key),value)
+
+/* define booleans */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+
+/* bucket states (calloc'd tables start out empty) */
+#define HASHMAP_EMPTY 0
+#define HASHMAP_FULL 1
+#define HASHMAP_DELETED 2
+
+/* capacity of the first table (must be a power of two) */
+#define HASHMAP_MIN_CAPACITY 16
+/* buckets moved from the old table on every put/erase while resizing */
+#define HASHMAP_MIGRATE_STEP 8
+
+/* default key equality */
+#define HASHMAP_EQUAL(a, b) (*(a) == *(b))
+
+/* call to setup the types (custom hash and equality) */
+#define init_hashmap_custom(key, value, hash, equal)                                        \
+                                                                                            \
+typedef struct h_entry(key,value) h_entry(key,value);                                       \
+typedef void (*EVALUATE(call_back,hashmap(key,value))) (const key*, value*);                \
+                                                                                            \
+struct h_entry(key,value)                                                                   \
+{                                                                                           \
+    key key_;                                                                               \
+    value value_;                                                                           \
+    unsigned char state_;                                                                   \
+};                                                                                          \
+                                                                                            \
+typedef struct                                                                              \
+{                                                                                           \
+    h_entry(key,value) * entries_;                                                          \
+    unsigned capacity_;                                                                     \
+    unsigned used_;                                                                         \
+} h_table(key,value);                                                                       \
+                                                                                            \
+typedef struct                                                                              \
+{                                                                                           \
+    h_table(key,value) current_;                                                            \
+    h_table(key,value) old_;                                                                \
+    unsigned migrate_;                                                                      \
+    unsigned size_;                                                                         \
+} hashmap(key,value);                                                                       \
+                                                                                            \
+hashmap(key,value) EVALUATE(create,hashmap(key,value)) (void)                               \
+{                                                                                           \
+    hashmap(key,value) map = {{NULL, 0, 0}, {NULL, 0, 0}, 0, 0};                            \
+    return map;                                                                             \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(clear,hashmap(key,value)) (hashmap(key,value) * map)                          \
+{                                                                                           \
+    if (!map) return;                                                                       \
+                                                                                            \
+    free(map->current_.entries_);                                                           \
+    free(map->old_.entries_);                                                               \
+                                                                                            \
+    *map = EVALUATE(create,hashmap(key,value))();                                           \
+}                                                                                           \
+                                                                                            \
+size_t EVALUATE(mix,hashmap(key,value)) (const key * k)                                     \
+{                                                                                           \
+    size_t h = (size_t)hash(k);                                                             \
+                                                                                            \
+    h ^= h >> 16;                                                                           \
+    h *= 0x45d9f3bu;                                                                        \
+    h ^= h >> 16;                                                                           \
+                                                                                            \
+    return h;                                                                               \
+}                                                                                           \
+                                                                                            \
+h_entry(key,value) * EVALUATE(find,hashmap(key,value)) (const h_table(key,value) * table,   \
+                     const key * k, size_t h)                                               \
+{                                                                                           \
+    h_entry(key,value) * entry;                                                             \
+    unsigned mask, i, probes;                                                               \
+                                                                                            \
+    if (!table->capacity_) return NULL;                                                     \
+                                                                                            \
+    mask = table->capacity_ - 1;                                                            \
+    i = (unsigned)h & mask;                                                                 \
+                                                                                            \
+    for (probes = 0; probes < table->capacity_; ++probes)                                   \
+    {                                                                                       \
+        entry = table->entries_ + i;                                                        \
+                                                                                            \
+        if (entry->state_ == HASHMAP_EMPTY) return NULL;                                    \
+        if (entry->state_ == HASHMAP_FULL && equal(&entry->key_, k)) return entry;          \
+                                                                                            \
+        i = (i + 1) & mask;                                                                 \
+    }                                                                                       \
+                                                                                            \
+    return NULL;                                                                            \
+}                                                                                           \
+                                                                                            \
+h_entry(key,value) * EVALUATE(slot,hashmap(key,value)) (h_table(key,value) * table,         \
+                     size_t h)                                                              \
+{                                                                                           \
+    unsigned mask = table->capacity_ - 1;                                                   \
+    unsigned i = (unsigned)h & mask;                                                        \
+                                                                                            \
+    while (table->entries_[i].state_ == HASHMAP_FULL)                                       \
+        i = (i + 1) & mask;                                                                 \
+                                                                                            \
+    return table->entries_ + i;                                                             \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(migrate,hashmap(key,value)) (hashmap(key,value) * map, unsigned steps)        \
+{                                                                                           \
+    h_entry(key,value) * entry;                                                             \
+    h_entry(key,value) * slot;                                                              \
+                                                                                            \
+    while (map->old_.entries_ && steps)                                                     \
+    {                                                                                       \
+        entry = map->old_.entries_ + map->migrate_++;                                       \
+        --steps;                                                                            \
+                                                                                            \
+        if (entry->state_ == HASHMAP_FULL)                                                  \
+        {                                                                                   \
+            slot = EVALUATE(slot,hashmap(key,value))(&map->current_,                        \
+                   EVALUATE(mix,hashmap(key,value))(&entry->key_));                         \
+            if (slot->state_ == HASHMAP_EMPTY)                                              \
+                ++map->current_.used_;                                                      \
+            slot->key_ = entry->key_;                                                       \
+            slot->value_ = entry->value_;                                                   \
+            slot->state_ = HASHMAP_FULL;                                                    \
+            entry->state_ = HASHMAP_DELETED;                                                \
+        }                                                                                   \
+                                                                                            \
+        if (map->migrate_ == map->old_.capacity_)                                           \
+        {                                                                                   \
+            free(map->old_.entries_);                                                       \
+            map->old_.entries_ = NULL;                                                      \
+            map->old_.capacity_ = 0;                                                        \
+            map->old_.used_ = 0;                                                            \
+            map->migrate_ = 0;                                                              \
+        }                                                                                   \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(grow,hashmap(key,value)) (hashmap(key,value) * map)                           \
+{                                                                                           \
+    h_table(key,value) table;                                                               \
+    unsigned capacity;                                                                      \
+                                                                                            \
+    EVALUATE(migrate,hashmap(key,value))(map, (unsigned)-1);                                \
+                                                                                            \
+    if (!map->current_.capacity_)                                                           \
+        capacity = HASHMAP_MIN_CAPACITY;                                                    \
+    else if (map->size_ * 2 >= map->current_.capacity_)                                     \
+        capacity = map->current_.capacity_ * 2;                                             \
+    else                                                                                    \
+        capacity = map->current_.capacity_;                                                 \
+                                                                                            \
+    table.entries_ = calloc(capacity, sizeof(h_entry(key,value)));                          \
+    if (!table.entries_) return false;                                                      \
+    table.capacity_ = capacity;                                                             \
+    table.used_ = 0;                                                                        \
+                                                                                            \
+    map->old_ = map->current_;                                                              \
+    map->current_ = table;                                                                  \
+    map->migrate_ = 0;                                                                      \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(put,hashmap(key,value)) (hashmap(key,value) * map, key k, value v)            \
+{                                                                                           \
+    h_entry(key,value) * entry;                                                             \
+    size_t h;                                                                               \
+                                                                                            \
+    if (!map) return false;                                                                 \
+                                                                                            \
+    EVALUATE(migrate,hashmap(key,value))(map, HASHMAP_MIGRATE_STEP);                        \
+                                                                                            \
+    if ((map->current_.used_ + 1) * 4 > map->current_.capacity_ * 3)                        \
+        if (!EVALUATE(grow,hashmap(key,value))(map)) return false;                          \
+                                                                                            \
+    h = EVALUATE(mix,hashmap(key,value))(&k);                                               \
+    entry = EVALUATE(find,hashmap(key,value))(&map->current_, &k, h);                       \
+                                                                                            \
+    if (entry)                                                                              \
+    {                                                                                       \
+        entry->value_ = v;                                                                  \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    if (map->old_.entries_)                                                                 \
+    {                                                                                       \
+        entry = EVALUATE(find,hashmap(key,value))(&map->old_, &k, h);                       \
+        if (entry)                                                                          \
+        {                                                                                   \
+            entry->state_ = HASHMAP_DELETED;                                                \
+            --map->size_;                                                                   \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    entry = EVALUATE(slot,hashmap(key,value))(&map->current_, h);                           \
+    if (entry->state_ == HASHMAP_EMPTY)                                                     \
+        ++map->current_.used_;                                                              \
+    entry->key_ = k;                                                                        \
+    entry->value_ = v;                                                                      \
+    entry->state_ = HASHMAP_FULL;                                                           \
+    ++map->size_;                                                                           \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+value * EVALUATE(get,hashmap(key,value)) (const hashmap(key,value) * map, key k)            \
+{                                                                                           \
+    h_entry(key,value) * entry;                                                             \
+    size_t h;                                                                               \
+                                                                                            \
+    if (!map) return NULL;                                                                  \
+                                                                                            \
+    h = EVALUATE(mix,hashmap(key,value))(&k);                                               \
+    entry = EVALUATE(find,hashmap(key,value))(&map->current_, &k, h);                       \
+                                                                                            \
+    if (!entry && map->old_.entries_)                                                       \
+        entry = EVALUATE(find,hashmap(key,value))(&map->old_, &k, h);                       \
+                                                                                            \
+    return entry ? &entry->value_ : NULL;                                                   \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(erase,hashmap(key,value)) (hashmap(key,value) * map, key k)                   \
+{                                                                                           \
+    h_entry(key,value) * entry;                                                             \
+    size_t h;                                                                               \
+                                                                                            \
+    if (!map) return false;                                                                 \
+                                                                                            \
+    EVALUATE(migrate,hashmap(key,value))(map, HASHMAP_MIGRATE_STEP);                        \
+                                                                                            \
+    h = EVALUATE(mix,hashmap(key,value))(&k);                                               \
+    entry = EVALUATE(find,hashmap(key,value))(&map->current_, &k, h);                       \
+                                                                                            \
+    if (!entry && map->old_.entries_)                                                       \
+        entry = EVALUATE(find,hashmap(key,value))(&map->old_, &k, h);                       \
+                                                                                            \
+    if (!entry) return false;                                                               \
+                                                                                            \
+    entry->state_ = HASHMAP_DELETED;                                                        \
+    --map->size_;                                                                           \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+unsigned EVALUATE(size,hashmap(key,value)) (const hashmap(key,value) * map)                 \
+{                                                                                           \
+    if (!map) return 0;                                                                     \
+                                                                                            \
+    return map->size_;                                                                      \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(foreach,hashmap(key,value)) (hashmap(key,value) * map,                        \
+             EVALUATE(call_back,hashmap(key,value)) cb)                                     \
+{                                                                                           \
+    unsigned i;                                                                             \
+                                                                                            \
+    if (!map) return;                                                                       \
+                                                                                            \
+    for (i = 0; i < map->current_.capacity_; ++i)                                           \
+        if (map->current_.entries_[i].state_ == HASHMAP_FULL)                               \
+            cb(&map->current_.entries_[i].key_, &map->current_.entries_[i].value_);         \
+                                                                                            \
+    for (i = map->migrate_; i < map->old_.capacity_; ++i)                                   \
+        if (map->old_.entries_[i].state_ == HASHMAP_FULL)                                   \
+            cb(&map->old_.entries_[i].key_, &map->old_.entries_[i].value_);                 \
+}                                                                                           \
+
+/* call to setup the types (bytewise hash, == equality) */
+#define init_hashmap(key, value)                                                            \
+                                                                                            \
+size_t EVALUATE(hash,hashmap(key,value)) (const key * k)                                    \
+{                                                                                           \
+    const unsigned char * bytes = (const unsigned char *)k;                                 \
+    size_t h = 2166136261u;                                                                 \
+    unsigned i;                                                                             \
+                                                                                            \
+    for (i = 0; i < sizeof(key); ++i)                                                       \
+    {                                                                                       \
+        h ^= bytes[i];                                                                      \
+        h *= 16777619u;                                                                     \
+    }                                                                                       \
+                                                                                            \
+    return h;                                                                               \
+}                                                                                           \
+                                                                                            \
+init_hashmap_custom(key, value, EVALUATE(hash,hashmap(key,value)), HASHMAP_EQUAL)           \
+
+/* Uniform function call syntax for all maps */
+#define create_hashmap(key, value) EVALUATE(create,hashmap(key,value)) ()
+/* clears the map and frees its tables */
+#define clear_hashmap(key, value, _map) EVALUATE(clear,hashmap(key,value)) (&_map)
+/* inserts or overwrites a value (bool) */
+#define put_hashmap(key, value, _map, _key, _value) EVALUATE(put,hashmap(key,value)) (&_map, _key, _value)
+/* gets a pointer to a value, NULL if the key is missing */
+#define get_hashmap(key, value, _map, _key) EVALUATE(get,hashmap(key,value)) (&_map, _key)
+/* removes a key (bool) */
+#define erase_hashmap(key, value, _map, _key) EVALUATE(erase,hashmap(key,value)) (&_map, _key)
+/* gets the number of keys in the map (unsigned) */
+#define size_hashmap(key, value, _map) EVALUATE(size,hashmap(key,value)) (&_map)
+/* runs a foreach on all key/value pairs within a map */
+#define foreach_hashmap(key, value, _map, _func) EVALUATE(foreach,hashmap(key,value)) (&_map, _func)
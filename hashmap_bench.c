@@ -0,0 +1,147 @@
+/******************************************************************************/
+/*
+* @file   hashmap_bench.c
+* @author Aditya Harsh
+* @brief  Lookup time of hashmap against scanning a list, at n = 100 to
+*         max_n keys (times ten). Every key looked up is in both, and the
+*         two have to agree on how many they found.
+*
+*         cc -std=c11 -O2 hashmap_bench.c -o hashmap_bench
+*         ./hashmap_bench [max_n]
+*/
+/******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
+#include "hashmap.h"    /* hashmap                */
+#include "list.h"       /* list                   */
+#include <stdio.h>      /* printf                 */
+#include <stdlib.h>     /* strtol                 */
+#include <time.h>       /* clock_gettime          */
+
+init_hashmap(int, int)
+init_list(int)
+
+/* lookups timed for each side (fewer for long list scans) */
+#define LOOKUPS 10000000L
+#define MIN_LOOKUPS 1000L
+
+/**
+ * @brief Returns a monotonic time in seconds.
+ *
+ */
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Picks the key for a lookup, spread over all n keys.
+ *
+ * @param i (the lookup number)
+ * @param n
+ * @return int
+ */
+static int key_of(long i, int n)
+{
+    return (int)((unsigned long)i * 7919ul % (unsigned long)n) * 7;
+}
+
+/**
+ * @brief Times lookups by walking the list until the key turns up.
+ *
+ * @param keys
+ * @param n
+ * @param lookups
+ * @param found (receives the number of keys found)
+ * @return double (nanoseconds per lookup)
+ */
+static double bench_list(list(int)* keys, int n, long lookups, long* found)
+{
+    l_node(int)* node;
+    double time = now();
+    long i;
+    int key;
+
+    *found = 0;
+
+    for (i = 0; i < lookups; ++i)
+    {
+        key = key_of(i, n);
+
+        for (node = keys->head_; node && node->data_ != key; node = node->next_);
+
+        if (node) ++*found;
+    }
+
+    return (now() - time) * 1e9 / (double)lookups;
+}
+
+/**
+ * @brief Times lookups in the map.
+ *
+ * @param map
+ * @param n
+ * @param lookups
+ * @param found (receives the number of keys found)
+ * @return double (nanoseconds per lookup)
+ */
+static double bench_map(hashmap(int, int)* map, int n, long lookups, long* found)
+{
+    double time = now();
+    long i;
+
+    *found = 0;
+
+    for (i = 0; i < lookups; ++i)
+        if (get_hashmap(int, int, *map, key_of(i, n))) ++*found;
+
+    return (now() - time) * 1e9 / (double)lookups;
+}
+
+int main(int argc, char** argv)
+{
+    long max_n = argc > 1 ? strtol(argv[1], NULL, 10) : 100000;
+    long lookups, list_found, map_found;
+    double list_time, map_time;
+    int n, i;
+
+    if (max_n < 100 || max_n > 10000000)
+    {
+        printf("usage: %s [max_n (100 to 10000000)]\n", argv[0]);
+        return 1;
+    }
+
+    printf("n          list scan       hashmap\n");
+
+    for (n = 100; n <= max_n; n *= 10)
+    {
+        hashmap(int, int) map = create_hashmap(int, int);
+        list(int) keys = create_list(int);
+
+        for (i = 0; i < n; ++i)
+        {
+            push_back_list(int, keys, i * 7);
+            put_hashmap(int, int, map, i * 7, i);
+        }
+
+        /* a scan costs about n, so keep its total time in check */
+        lookups = LOOKUPS / n;
+        if (lookups < MIN_LOOKUPS) lookups = MIN_LOOKUPS;
+
+        list_time = bench_list(&keys, n, lookups, &list_found);
+        map_time = bench_map(&map, n, lookups * 100, &map_found);
+
+        printf("%-9d  %9.1f ns  %9.1f ns%s\n", n, list_time, map_time,
+               list_found * 100 != map_found ? " (MISMATCH)" : "");
+
+        clear_hashmap(int, int, map);
+        clear_list(int, keys);
+    }
+
+    return 0;
+}
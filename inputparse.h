@@ -6,24 +6,57 @@
 */
 /******************************************************************************/
 
-#include <vector>    /* std::vector                      */
-#include <fstream>   /* std::ifstream                    */
-#include <sstream>   /* std::string, std::isstringstream */
-#include <iterator>  /* std::istream_iterator            */
+#pragma once
+
+#include <vector>       /* std::vector                      */
+#include <fstream>      /* std::ifstream                    */
+#include <sstream>      /* std::string, std::isstringstream */
+#include <iterator>     /* std::istream_iterator            */
+#include <charconv>     /* std::from_chars                  */
+#include <cstring>      /* std::memchr                      */
+#include <type_traits>  /* std::is_arithmetic_v, ...        */
+#include <limits>       /* std::numeric_limits              */
+#include <thread>       /* std::thread                      */
+#include <exception>    /* std::exception_ptr               */
+#include <utility>      /* std::pair, std::move             */
+#include <algorithm>    /* std::copy, std::min              */
+#include <cstdio>       /* std::rename, std::remove         */
+#include <cstdint>      /* std::uint64_t, std::int64_t      */
+#include <memory>       /* std::unique_ptr, std::shared_ptr */
+#include <tuple>        /* std::tuple, std::apply           */
+#include <string_view>  /* std::string_view                 */
+#include <mutex>        /* std::mutex, std::lock_guard      */
+#include <condition_variable> /* std::condition_variable    */
+#include <cerrno>       /* errno, EINTR                     */
+#include "inputparse_simd.h" /* Classify, DecodeShortDecimal */
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>      /* open                             */
+#include <unistd.h>     /* close, getpid, pread             */
+#include <sys/mman.h>   /* mmap, munmap, madvise            */
+#include <sys/stat.h>   /* fstat, stat                      */
+#define INPUTPARSE_MMAP
+#endif
+
+/* smallest piece of a file worth its own thread */
+#ifndef INPUTPARSE_MIN_CHUNK
+#define INPUTPARSE_MIN_CHUNK (1 << 20)
+#endif
 
 /**
  * @brief Input parsing to allow for easy reading of files.
- * 
+ *
  */
 namespace InputParse
 {
     /**
-     * @brief Returns a vector of vector of data.
-     * 
-     * @param file_name 
+     * @brief Returns a vector of vector of data, reading through streams.
+     *        Works for any T with an operator>>.
+     *
+     * @param file_name
      */
     template <typename T>
-    std::vector<std::vector<T>> Parse(const std::string& file_name)
+    std::vector<std::vector<T>> ParseStream(const std::string& file_name)
     {
         // data to create
         std::vector<std::vector<T>> data;
@@ -56,11 +89,1842 @@ namespace InputParse
 
                 // get the data on the line
                 std::vector<T> line_data ((std::istream_iterator<T>(is)), std::istream_iterator<T>());
-                
+
                 data.back().insert(std::end(data.back()), std::cbegin(line_data), std::cend(line_data));
             }
         }
 
         return data;
     }
+
+    namespace detail
+    {
+        /**
+         * @brief Read-only view of a whole file, mapped where mmap exists.
+         *
+         */
+        class MappedFile
+        {
+        public:
+            /**
+             * @brief Maps a file. Check with is_open.
+             *
+             * @param file_name
+             */
+            explicit MappedFile(const std::string& file_name) noexcept
+            {
+#ifdef INPUTPARSE_MMAP
+                int fd = open(file_name.c_str(), O_RDONLY);
+                struct stat info;
+
+                if (fd < 0) return;
+
+                if (!fstat(fd, &info))
+                {
+                    size_ = static_cast<std::size_t>(info.st_size);
+
+                    if (!size_)
+                    {
+                        // nothing to map, but the file is there
+                        data_ = "";
+                        open_ = true;
+                    }
+                    else if (void* memory = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                             memory != MAP_FAILED)
+                    {
+                        madvise(memory, size_, MADV_SEQUENTIAL);
+
+                        data_ = static_cast<const char*>(memory);
+                        mapped_ = true;
+                        open_ = true;
+                    }
+                }
+
+                close(fd);
+#else
+                (void)file_name;
+#endif
+            }
+
+            /**
+             * @brief Unmaps the file.
+             *
+             */
+            ~MappedFile() noexcept
+            {
+#ifdef INPUTPARSE_MMAP
+                if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            bool is_open() const noexcept { return open_; }
+            const char* data() const noexcept { return data_; }
+            std::size_t size() const noexcept { return size_; }
+
+        private:
+            const char* data_ = nullptr;
+            std::size_t size_ = 0;
+            bool mapped_ = false;
+            bool open_ = false;
+        };
+
+        // types read straight out of the text (char types read single characters instead)
+        template <typename T>
+        constexpr bool is_fast_parsable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                          !std::is_same_v<T, char> && !std::is_same_v<T, signed char> &&
+                                          !std::is_same_v<T, unsigned char> && !std::is_same_v<T, wchar_t> &&
+                                          !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+        /**
+         * @brief The whitespace operator>> skips (the classic locale's).
+         *
+         * @param c
+         */
+        constexpr bool IsSpace(char c) noexcept
+        {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        constexpr bool IsDigit(char c) noexcept
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        /**
+         * @brief Reads an integer the way operator>> does: an optional sign,
+         *        then decimal digits. Unsigned types take a minus sign and
+         *        wrap, like strtoul.
+         *
+         * @tparam T
+         * @param first (moved past the token on success)
+         * @param last
+         * @param value
+         * @return true
+         * @return false (no number, or it doesn't fit)
+         */
+        template <typename T>
+        bool ParseInteger(const char*& first, const char* last, T& value) noexcept
+        {
+            // the sign is skipped without a branch, it's a coin flip in most input
+            const bool negative = *first == '-';
+            const char* digits = first + (negative || *first == '+');
+
+            if (digits == last || !IsDigit(*digits)) return false;
+
+            // up to eight digits fit in 32 bits and decode at once
+            std::uint32_t decoded;
+
+            if (std::size_t count = DecodeShortDecimal(digits, last, decoded))
+            {
+                // a minus sign allows one more on signed types
+                const std::uint64_t limit = std::uint64_t(std::numeric_limits<T>::max()) +
+                                            (std::is_signed_v<T> && negative);
+
+                if (decoded > limit) return false;
+
+                if constexpr (std::is_signed_v<T>)
+                    value = negative ? static_cast<T>(-static_cast<std::int64_t>(decoded)) : static_cast<T>(decoded);
+                else
+                    value = negative ? static_cast<T>(T(0) - static_cast<T>(decoded)) : static_cast<T>(decoded);
+
+                first = digits + count;
+                return true;
+            }
+
+            // from_chars takes a minus sign on signed types itself
+            if constexpr (std::is_signed_v<T>)
+                if (negative) digits = first;
+
+            auto [end, error] = std::from_chars(digits, last, value);
+            if (error != std::errc()) return false;
+
+            if constexpr (std::is_unsigned_v<T>)
+                if (negative) value = static_cast<T>(T(0) - value);
+
+            first = end;
+            return true;
+        }
+
+        /**
+         * @brief Tells underflow from overflow in a number from_chars found
+         *        out of range: underflow if its first significant digit sits
+         *        right of the point once the exponent is applied.
+         *
+         * @param first (past any sign)
+         * @param last
+         */
+        inline bool Underflows(const char* first, const char* last) noexcept
+        {
+            long long position = 0, exponent = 0;
+            bool point = false, negative = false;
+
+            // places the first significant digit is left of the point
+            for (; first != last && *first != 'e' && *first != 'E'; ++first)
+            {
+                if (*first == '.')
+                    point = true;
+                else if (*first != '0')
+                    break;
+                else if (point)
+                    --position;
+            }
+
+            for (; first != last && IsDigit(*first) && !point; ++first)
+                ++position;
+
+            while (first != last && *first != 'e' && *first != 'E')
+                ++first;
+
+            if (first != last && ++first != last && (*first == '+' || *first == '-'))
+                negative = *first++ == '-';
+
+            for (; first != last && exponent < 1000000; ++first)
+                exponent = exponent * 10 + (*first - '0');
+
+            return position + (negative ? -exponent : exponent) <= 0;
+        }
+
+        /**
+         * @brief Reads a floating point number the way operator>> does. The
+         *        stream collects an optional sign, digits with one point and
+         *        an exponent, then needs all of it to convert. The same span
+         *        goes to from_chars here.
+         *
+         * @tparam T
+         * @param first (moved past the token on success)
+         * @param last
+         * @param value
+         * @return true
+         * @return false (no number, or it overflows)
+         */
+        template <typename T>
+        bool ParseFloat(const char*& first, const char* last, T& value) noexcept
+        {
+            const char* digits = first;
+            const char* end;
+            bool negative = false, mantissa = false, point = false;
+
+            if (*digits == '+' || *digits == '-')
+            {
+                negative = *digits == '-';
+                ++digits;
+            }
+
+            for (end = digits; end != last; ++end)
+            {
+                if (IsDigit(*end))
+                    mantissa = true;
+                else if (*end == '.' && !point)
+                    point = true;
+                else
+                    break;
+            }
+
+            // an exponent only counts after some digits
+            if (end != last && (*end == 'e' || *end == 'E') && mantissa)
+            {
+                if (++end != last && (*end == '+' || *end == '-'))
+                    ++end;
+
+                while (end != last && IsDigit(*end))
+                    ++end;
+            }
+
+            // from_chars doesn't take a plus sign
+            auto [stop, error] = std::from_chars(negative ? first : digits, end, value);
+            if (stop != end) return false;
+
+            if (error == std::errc::result_out_of_range)
+            {
+                // the stream fails on overflow, but underflow reads as zero
+                if (!Underflows(digits, end)) return false;
+
+                value = negative ? -T(0) : T(0);
+            }
+            else if (error != std::errc())
+            {
+                return false;
+            }
+
+            first = end;
+            return true;
+        }
+
+        /**
+         * @brief Reads one number, like operator>> without skipping spaces.
+         *
+         * @tparam T
+         * @param first (moved past the token on success)
+         * @param last
+         * @param value
+         */
+        template <typename T>
+        bool ParseNumber(const char*& first, const char* last, T& value) noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                return ParseFloat(first, last, value);
+            else
+                return ParseInteger(first, last, value);
+        }
+
+        /**
+         * @brief Appends the numbers from first on, a byte at a time.
+         *
+         * @tparam T
+         * @param first
+         * @param last (the end of the line)
+         * @param values
+         */
+        template <typename T>
+        void ParseRest(const char* first, const char* last, std::vector<T>& values)
+        {
+            T value;
+
+            while (true)
+            {
+                while (first != last && IsSpace(*first))
+                    ++first;
+
+                if (first == last || !ParseNumber(first, last, value)) return;
+
+                values.push_back(value);
+            }
+        }
+
+        /**
+         * @brief Appends the numbers on a line, stopping at the first token
+         *        that isn't one (like reading the line through an
+         *        istream_iterator).
+         *
+         * @tparam T
+         * @param first
+         * @param last (the end of the line)
+         * @param values
+         */
+        template <typename T>
+        void ParseLine(const char* first, const char* last, std::vector<T>& values)
+        {
+            if constexpr (is_fast_parsable<T>)
+            {
+                T value;
+
+                // tokens start where a space is followed by anything else,
+                // found a block at a time (a line shorter than a block isn't
+                // worth it)
+                const std::size_t size = static_cast<std::size_t>(last - first);
+                std::uint64_t carry = 1;
+
+                if (size < block_size)
+                {
+                    ParseRest(first, last, values);
+                    return;
+                }
+
+                for (std::size_t offset = 0; offset < size; offset += block_size)
+                {
+                    const std::uint64_t spaces = Classify(first, first + offset, last).spaces;
+                    std::uint64_t starts = ~spaces & ((spaces << 1) | carry);
+
+                    carry = spaces >> (block_size - 1);
+
+                    for (; starts; starts &= starts - 1)
+                    {
+                        const char* token = first + offset + TrailingZeros(starts);
+
+                        if (!ParseNumber(token, last, value)) return;
+
+                        values.push_back(value);
+
+                        // stopped inside a token ("1.2.3"), the stream reads on from there
+                        if (token != last && !IsSpace(*token))
+                        {
+                            ParseRest(token, last, values);
+                            return;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // anything else goes through operator>>
+                std::istringstream is(std::string(first, last));
+
+                values.insert(std::end(values), std::istream_iterator<T>(is), std::istream_iterator<T>());
+            }
+        }
+
+        /**
+         * @brief Hands out the lines of a mapped file. Newlines are found a
+         *        block at a time and kept as a bitmask until they're used.
+         *
+         */
+        class MappedLines
+        {
+        public:
+            MappedLines(const char* first, const char* last) noexcept
+                : first_(first), last_(last), block_(first), next_(0), newlines_(0)
+            {
+            }
+
+            /**
+             * @brief Gets the next line, without its newline.
+             *
+             * @param first
+             * @param last
+             * @return true
+             * @return false (the file is done)
+             */
+            bool Next(const char*& first, const char*& last) noexcept
+            {
+                if (first_ == last_) return false;
+
+                // move on to the next block holding a newline
+                while (!newlines_)
+                {
+                    const std::size_t size = static_cast<std::size_t>(last_ - block_);
+
+                    if (next_ >= size)
+                    {
+                        // a last line without a newline
+                        first = first_;
+                        last = first_ = last_;
+                        return true;
+                    }
+
+                    block_ += next_;
+                    newlines_ = Classify(first_, block_, last_).newlines;
+                    next_ = block_size;
+                }
+
+                first = first_;
+                last = block_ + TrailingZeros(newlines_);
+                first_ = last + 1;
+                newlines_ &= newlines_ - 1;
+
+                return true;
+            }
+
+            // where the next line starts
+            const char* position() const noexcept { return first_; }
+
+        private:
+            // what's left of the file
+            const char* first_;
+            const char* last_;
+            // the block the mask describes, how far on the next one is, and
+            // the newlines not handed out yet
+            const char* block_;
+            std::size_t next_;
+            std::uint64_t newlines_;
+        };
+
+        /**
+         * @brief Reads a file ahead of whoever's using it, on a thread of its
+         *        own: up to depth buffers are read (with pread where there is
+         *        one) while the ones read already are used, so the disk is
+         *        busy while the data is parsed. Falls back to reading inline
+         *        if the thread can't be started.
+         *
+         */
+        class ReadAhead
+        {
+        public:
+            /**
+             * @brief Opens a file and starts reading it. Check with is_open.
+             *
+             * @param file_name
+             * @param buffer_size (bytes per read)
+             * @param depth (reads in flight, at least 1)
+             */
+            ReadAhead(const std::string& file_name, std::size_t buffer_size, unsigned depth)
+                : buffers_(depth ? depth : 1, std::vector<char>(buffer_size ? buffer_size : 1)), sizes_(buffers_.size())
+            {
+#ifdef INPUTPARSE_MMAP
+                fd_ = open(file_name.c_str(), O_RDONLY);
+                if (fd_ < 0) return;
+#else
+                input_.open(file_name, std::ios::binary);
+                if (!input_.good()) return;
+#endif
+
+                open_ = true;
+
+                try
+                {
+                    thread_ = std::thread(&ReadAhead::Run, this);
+                }
+                catch (...)
+                {
+                    // out of threads, reads happen as they're asked for
+                }
+            }
+
+            ReadAhead(const ReadAhead&) = delete;
+            ReadAhead& operator=(const ReadAhead&) = delete;
+
+            /**
+             * @brief Stops reading and closes the file.
+             *
+             */
+            ~ReadAhead()
+            {
+                if (thread_.joinable())
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stop_ = true;
+                    }
+
+                    free_.notify_one();
+                    thread_.join();
+                }
+
+#ifdef INPUTPARSE_MMAP
+                if (fd_ >= 0) close(fd_);
+#endif
+            }
+
+            bool is_open() const noexcept { return open_; }
+
+            /**
+             * @brief Copies the next size bytes of the file out of the
+             *        buffers read so far, waiting on the ones still being
+             *        read.
+             *
+             * @param data
+             * @param size
+             * @return std::size_t (less than size only at the end of the file)
+             */
+            std::size_t Read(char* data, std::size_t size)
+            {
+                std::size_t copied = 0;
+
+                if (!thread_.joinable()) return open_ ? ReadBlock(data, size) : 0;
+
+                while (copied < size)
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+
+                    ready_.wait(lock, [this]() { return taken_ < filled_ || done_; });
+                    if (taken_ == filled_) break;
+
+                    // the thread leaves the buffer alone until it's given back
+                    lock.unlock();
+
+                    const std::size_t index = taken_ % buffers_.size();
+                    const std::size_t count = std::min(size - copied, sizes_[index] - offset_);
+
+                    std::memcpy(data + copied, buffers_[index].data() + offset_, count);
+                    copied += count;
+                    offset_ += count;
+
+                    if (offset_ == sizes_[index])
+                    {
+                        offset_ = 0;
+
+                        lock.lock();
+                        ++taken_;
+                        lock.unlock();
+
+                        free_.notify_one();
+                    }
+                }
+
+                return copied;
+            }
+
+        private:
+            /**
+             * @brief Reads the next size bytes of the file, or what's left.
+             *
+             * @param data
+             * @param size
+             * @return std::size_t
+             */
+            std::size_t ReadBlock(char* data, std::size_t size)
+            {
+                std::size_t read = 0;
+
+#ifdef INPUTPARSE_MMAP
+                while (read < size)
+                {
+                    ssize_t count = pread(fd_, data + read, size - read, static_cast<off_t>(position_ + read));
+
+                    if (count < 0 && errno == EINTR) continue;
+                    // a read error ends the file, like a failed stream
+                    if (count <= 0) break;
+
+                    read += static_cast<std::size_t>(count);
+                }
+#else
+                input_.read(data, static_cast<std::streamsize>(size));
+                read = static_cast<std::size_t>(input_.gcount());
+#endif
+
+                position_ += read;
+
+                return read;
+            }
+
+            /**
+             * @brief Fills buffers in turn as they're given back, until the
+             *        file runs out or it's told to stop.
+             *
+             */
+            void Run()
+            {
+                for (std::size_t index = 0; ; index = (index + 1) % buffers_.size())
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+
+                        free_.wait(lock, [this]() { return filled_ - taken_ < buffers_.size() || stop_; });
+                        if (stop_) return;
+                    }
+
+                    const std::size_t read = ReadBlock(buffers_[index].data(), buffers_[index].size());
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+
+                        sizes_[index] = read;
+                        filled_ += read != 0;
+                        done_ = read < buffers_[index].size();
+                    }
+
+                    ready_.notify_one();
+
+                    if (read < buffers_[index].size()) return;
+                }
+            }
+
+#ifdef INPUTPARSE_MMAP
+            int fd_ = -1;
+#else
+            std::ifstream input_;
+#endif
+            bool open_ = false;
+            // where the next read starts (only the thread reads, once it's going)
+            std::size_t position_ = 0;
+
+            std::vector<std::vector<char>> buffers_;
+            std::vector<std::size_t> sizes_;
+            // buffers read, and buffers used and given back (both only go up)
+            std::size_t filled_ = 0;
+            std::size_t taken_ = 0;
+            // how far into the buffer being used the next copy starts
+            std::size_t offset_ = 0;
+            bool done_ = false;
+            bool stop_ = false;
+
+            std::mutex mutex_;
+            // signalled when a buffer is read, and when one is given back
+            std::condition_variable ready_;
+            std::condition_variable free_;
+            std::thread thread_;
+        };
+
+        /**
+         * @brief Reads a file a line at a time through one buffer, which only
+         *        grows past its starting size to fit a longer line. Given a
+         *        read-ahead depth, the file is read on another thread.
+         *
+         */
+        class LineReader
+        {
+        public:
+            /**
+             * @brief Opens a file. Check with is_open.
+             *
+             * @param file_name
+             * @param buffer_size
+             * @param read_ahead (reads kept in flight on another thread, 0 = read here)
+             */
+            LineReader(const std::string& file_name, std::size_t buffer_size, unsigned read_ahead = 0)
+                : buffer_(buffer_size ? buffer_size : 1)
+            {
+                if (read_ahead)
+                    ahead_ = std::make_unique<ReadAhead>(file_name, buffer_.size(), read_ahead);
+                else
+                    input_.open(file_name, std::ios::binary);
+            }
+
+            bool is_open() const noexcept { return ahead_ ? ahead_->is_open() : input_.good(); }
+
+            /**
+             * @brief Gets the next line, without its newline. The line stays
+             *        valid until the next call.
+             *
+             * @param first
+             * @param last
+             * @return true
+             * @return false (the file is done)
+             */
+            bool Next(const char*& first, const char*& last)
+            {
+                while (true)
+                {
+                    const char* data = buffer_.data();
+
+                    if (auto end = static_cast<const char*>(std::memchr(data + begin_, '\n', end_ - begin_)))
+                    {
+                        first = data + begin_;
+                        last = end;
+                        begin_ = static_cast<std::size_t>(end - data) + 1;
+                        return true;
+                    }
+
+                    // a last line without a newline still counts
+                    if (done_)
+                    {
+                        if (begin_ == end_) return false;
+
+                        first = data + begin_;
+                        last = data + end_;
+                        begin_ = end_;
+                        return true;
+                    }
+
+                    // keep the partial line, it's finished by the next read
+                    std::memmove(buffer_.data(), data + begin_, end_ - begin_);
+                    end_ -= begin_;
+                    begin_ = 0;
+
+                    if (end_ == buffer_.size())
+                        buffer_.resize(buffer_.size() * 2);
+
+                    if (ahead_)
+                    {
+                        const std::size_t room = buffer_.size() - end_, read = ahead_->Read(buffer_.data() + end_, room);
+
+                        end_ += read;
+                        done_ = read < room;
+                    }
+                    else
+                    {
+                        input_.read(buffer_.data() + end_, static_cast<std::streamsize>(buffer_.size() - end_));
+                        end_ += static_cast<std::size_t>(input_.gcount());
+                        done_ = !input_;
+                    }
+                }
+            }
+
+        private:
+            std::ifstream input_;
+            std::unique_ptr<ReadAhead> ahead_;
+            std::vector<char> buffer_;
+            // the bytes read but not handed out yet
+            std::size_t begin_ = 0;
+            std::size_t end_ = 0;
+            bool done_ = false;
+        };
+
+        /**
+         * @brief Reads the case count off the first line, like ParseStream.
+         *
+         * @tparam Lines (MappedLines or LineReader)
+         * @param lines
+         */
+        template <typename Lines>
+        unsigned long ReadCaseCount(Lines& lines)
+        {
+            const char* first = nullptr;
+            const char* last = nullptr;
+
+            return std::stoul(lines.Next(first, last) ? std::string(first, last) : std::string());
+        }
+
+        /**
+         * @brief Splits the lines after the case count into cases. Every
+         *        blank line starts a case, up to cases of them, and lines in
+         *        between go to the case before them. Lines before the first
+         *        case are skipped.
+         *
+         * @tparam Lines (MappedLines or LineReader)
+         * @param lines
+         * @param cases
+         * @param start_case (called as each case starts, returning false stops)
+         * @param add_line (called with each line in a case)
+         */
+        template <typename Lines, typename StartCase, typename AddLine>
+        void SplitCases(Lines& lines, unsigned long cases, StartCase&& start_case, AddLine&& add_line)
+        {
+            const char* first = nullptr;
+            const char* last = nullptr;
+            std::size_t started = 0;
+
+            while (lines.Next(first, last))
+            {
+                // blank lines start cases
+                if (first == last)
+                {
+                    if (started >= cases || !start_case()) return;
+
+                    ++started;
+                    continue;
+                }
+
+                if (started)
+                    add_line(first, last);
+            }
+        }
+
+        /**
+         * @brief Guesses how many values a file holds from the tokens in its
+         *        first 64 KB, erring a little high.
+         *
+         * @param first
+         * @param last
+         * @return std::size_t
+         */
+        inline std::size_t EstimateValues(const char* first, const char* last) noexcept
+        {
+            const std::size_t size = static_cast<std::size_t>(last - first);
+            const std::size_t sample = size < (1 << 16) ? size : (1 << 16);
+            std::size_t tokens = 0;
+            bool space = true;
+
+            for (std::size_t i = 0; i < sample; ++i)
+            {
+                tokens += space && !IsSpace(first[i]);
+                space = IsSpace(first[i]);
+            }
+
+            if (!sample) return 0;
+
+            return static_cast<std::size_t>(static_cast<double>(tokens) / sample * size * 1.05) + 1;
+        }
+
+        /**
+         * @brief Splits text into about threads pieces, each starting on a
+         *        blank line (so on a case) except the first.
+         *
+         * @param first
+         * @param last
+         * @param threads (0 = one per core)
+         * @return std::vector<std::pair<const char*, const char*>>
+         */
+        inline std::vector<std::pair<const char*, const char*>> SplitChunks(const char* first, const char* last,
+                                                                           unsigned threads)
+        {
+            std::vector<std::pair<const char*, const char*>> chunks;
+            const std::size_t size = static_cast<std::size_t>(last - first);
+            std::size_t pieces;
+
+            if (!threads) threads = std::thread::hardware_concurrency();
+            pieces = std::min<std::size_t>(threads ? threads : 1, size / INPUTPARSE_MIN_CHUNK + 1);
+
+            for (std::size_t i = 1; i < pieces; ++i)
+            {
+                const char* begin = chunks.empty() ? first : chunks.back().second;
+                const char* split = first + size / pieces * i;
+                const char* end;
+
+                // a newline right after a newline is a blank line
+                for (split = std::max(split, begin + 1) - 1; split < last; split = end + 1)
+                {
+                    end = static_cast<const char*>(std::memchr(split, '\n', static_cast<std::size_t>(last - split)));
+                    if (!end || end + 1 == last) { split = last; break; }
+                    if (end[1] == '\n') { split = end + 1; break; }
+                }
+
+                if (split >= last) break;
+
+                chunks.emplace_back(begin, split);
+            }
+
+            chunks.emplace_back(chunks.empty() ? first : chunks.back().second, last);
+
+            return chunks;
+        }
+
+        /**
+         * @brief Runs work(0) to work(count - 1) at once, one thread each
+         *        (work(0) on this one), and rethrows the first exception.
+         *
+         * @param count
+         * @param work
+         */
+        template <typename Work>
+        void RunParallel(std::size_t count, Work&& work)
+        {
+            std::vector<std::exception_ptr> errors(count);
+            std::vector<std::thread> threads;
+            std::size_t spawned = 1;
+
+            auto run = [&](std::size_t i)
+            {
+                try
+                {
+                    work(i);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            };
+
+            try
+            {
+                threads.reserve(count);
+                for (; spawned < count; ++spawned)
+                    threads.emplace_back(run, spawned);
+            }
+            catch (...)
+            {
+                // out of threads, the rest run here
+            }
+
+            for (std::size_t i = spawned; i < count; ++i)
+                run(i);
+
+            if (count) run(0);
+
+            for (auto& thread : threads)
+                thread.join();
+
+            for (auto& error : errors)
+                if (error) std::rethrow_exception(error);
+        }
+
+        /**
+         * @brief Parses a mapped file straight out of memory, in pieces on
+         *        several threads if asked to, then puts the cases together
+         *        in order.
+         *
+         * @tparam T
+         * @param file
+         * @param threads (0 = one per core)
+         */
+        template <typename T>
+        std::vector<std::vector<T>> ParseMapped(const MappedFile& file, unsigned threads)
+        {
+            // data to create
+            std::vector<std::vector<T>> data;
+
+            MappedLines lines(file.data(), file.data() + file.size());
+
+            auto cases = ReadCaseCount(lines); // get the total number of cases to account for
+            auto chunks = SplitChunks(lines.position(), file.data() + file.size(), threads);
+            std::vector<std::vector<std::vector<T>>> parts(chunks.size());
+
+            RunParallel(chunks.size(), [&](std::size_t i)
+            {
+                MappedLines chunk(chunks[i].first, chunks[i].second);
+                auto& part = parts[i];
+
+                SplitCases(chunk, cases,
+                           [&]() { part.emplace_back(); return true; },
+                           [&](const char* first, const char* last) { ParseLine(first, last, part.back()); });
+            });
+
+            data.reserve(cases);
+
+            // only the first cases count, like a single pass
+            for (auto& part : parts)
+                for (std::size_t i = 0; i < part.size() && data.size() < cases; ++i)
+                    data.push_back(std::move(part[i]));
+
+            return data;
+        }
+    }
+
+    /**
+     * @brief Contiguous run of values (a minimal std::span).
+     *
+     * @tparam T
+     */
+    template <typename T>
+    class Span
+    {
+    public:
+        constexpr Span(T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+        constexpr T* data() const noexcept { return data_; }
+        constexpr std::size_t size() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return !size_; }
+        constexpr T* begin() const noexcept { return data_; }
+        constexpr T* end() const noexcept { return data_ + size_; }
+        constexpr T& operator[](std::size_t index) const noexcept { return data_[index]; }
+
+    private:
+        T* data_;
+        std::size_t size_;
+    };
+
+    /**
+     * @brief Every case's values in one array (compressed sparse rows).
+     *        Case i is values[case_offsets[i]] up to values[case_offsets[i + 1]].
+     *
+     * @tparam T
+     */
+    template <typename T>
+    struct FlatCases
+    {
+        // every value, case after case
+        std::vector<T> values;
+        // where each case starts, then one past the last value
+        std::vector<std::size_t> case_offsets{0};
+
+        std::size_t size() const noexcept { return case_offsets.size() - 1; }
+        bool empty() const noexcept { return size() == 0; }
+
+        Span<const T> operator[](std::size_t index) const noexcept
+        {
+            return Span<const T>(values.data() + case_offsets[index], case_offsets[index + 1] - case_offsets[index]);
+        }
+
+        Span<T> operator[](std::size_t index) noexcept
+        {
+            return Span<T>(values.data() + case_offsets[index], case_offsets[index + 1] - case_offsets[index]);
+        }
+    };
+
+    /**
+     * @brief Names the fields of a row, in order, for Parse. Each field is a
+     *        number (as in Parse), a std::string_view into the file, or a
+     *        std::string.
+     *
+     * @tparam Ts
+     */
+    template <typename... Ts>
+    struct Schema
+    {
+    };
+
+    /**
+     * @brief Rows read through a Schema, one array per field, with an
+     *        offset array marking where each case's rows start (like
+     *        FlatCases). Case i is rows case_offsets[i] up to
+     *        case_offsets[i + 1] of every column.
+     *
+     * @tparam Ts
+     */
+    template <typename... Ts>
+    struct Columns
+    {
+        // field I of every row, case after case
+        std::tuple<std::vector<Ts>...> columns;
+        // where each case starts, then one past the last row
+        std::vector<std::size_t> case_offsets{0};
+        // the file text, kept while string_view fields point into it
+        std::shared_ptr<const void> text;
+
+        std::size_t size() const noexcept { return case_offsets.size() - 1; }
+        bool empty() const noexcept { return size() == 0; }
+        std::size_t rows() const noexcept { return case_offsets.back(); }
+
+        template <std::size_t I>
+        const auto& column() const noexcept { return std::get<I>(columns); }
+
+        template <std::size_t I>
+        auto& column() noexcept { return std::get<I>(columns); }
+
+        /**
+         * @brief Field I of the rows in one case.
+         *
+         * @tparam I
+         * @param index
+         */
+        template <std::size_t I>
+        auto column(std::size_t index) const noexcept
+        {
+            using Field = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+            return Span<const Field>(std::get<I>(columns).data() + case_offsets[index],
+                                     case_offsets[index + 1] - case_offsets[index]);
+        }
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        constexpr bool is_schema_field = is_fast_parsable<T> || std::is_same_v<T, std::string_view> ||
+                                         std::is_same_v<T, std::string>;
+
+        // what Parse<T> returns
+        template <typename T>
+        struct ParseResult
+        {
+            using type = std::vector<std::vector<T>>;
+        };
+
+        template <typename... Ts>
+        struct ParseResult<Schema<Ts...>>
+        {
+            using type = Columns<Ts...>;
+        };
+
+        template <typename T>
+        constexpr bool is_schema = false;
+
+        template <typename... Ts>
+        constexpr bool is_schema<Schema<Ts...>> = true;
+
+        /**
+         * @brief Reads the next token as one field. A number has to take up
+         *        the whole token.
+         *
+         * @tparam T
+         * @param first (moved past the token on success)
+         * @param last (the end of the line)
+         * @param value
+         * @return true
+         * @return false (the line ran out, or the token isn't a T)
+         */
+        template <typename T>
+        bool ParseField(const char*& first, const char* last, T& value)
+        {
+            while (first != last && IsSpace(*first))
+                ++first;
+
+            if (first == last) return false;
+
+            if constexpr (is_fast_parsable<T>)
+            {
+                return ParseNumber(first, last, value) && (first == last || IsSpace(*first));
+            }
+            else
+            {
+                const char* token = first;
+
+                while (first != last && !IsSpace(*first))
+                    ++first;
+
+                value = T(token, static_cast<std::size_t>(first - token));
+                return true;
+            }
+        }
+
+        /**
+         * @brief Reads a line as one row, field by field in order. The calls
+         *        are laid out at compile time, one per field.
+         *
+         * @param first
+         * @param last (the end of the line)
+         * @param row
+         * @return true
+         * @return false (a field is missing or isn't its type)
+         */
+        template <typename... Ts, std::size_t... I>
+        bool ParseRow(const char* first, const char* last, std::tuple<Ts...>& row, std::index_sequence<I...>)
+        {
+            return (ParseField(first, last, std::get<I>(row)) && ...);
+        }
+
+        /**
+         * @brief Appends the rows in lines to columns, one row per line.
+         *        Lines that don't hold a whole row are skipped, so the
+         *        columns never go out of step. Tokens past the last field
+         *        are ignored. Cases are split as in Parse.
+         *
+         * @param lines
+         * @param cases
+         * @param data (its case_offsets are filled in from scratch)
+         */
+        template <typename... Ts>
+        void ParseRows(MappedLines& lines, unsigned long cases, Columns<Ts...>& data)
+        {
+            std::tuple<Ts...> row;
+            std::size_t rows = 0;
+
+            data.case_offsets.clear();
+
+            SplitCases(lines, cases,
+                       [&]() { data.case_offsets.push_back(rows); return true; },
+                       [&](const char* first, const char* last)
+                       {
+                           if (!ParseRow(first, last, row, std::index_sequence_for<Ts...>())) return;
+
+                           std::apply([&](auto&... fields)
+                           {
+                               std::apply([&](auto&... column) { (column.push_back(std::move(fields)), ...); },
+                                          data.columns);
+                           }, row);
+
+                           ++rows;
+                       });
+
+            data.case_offsets.push_back(rows);
+        }
+
+        /**
+         * @brief Parses a file through a schema, in pieces on several threads
+         *        if asked to (as in ParseMapped), then puts the cases
+         *        together in order. The file is mapped where it can be, and
+         *        read in whole otherwise.
+         *
+         * @param file_name
+         * @param threads (0 = one per core)
+         * @return Columns<Ts...>
+         */
+        template <typename... Ts>
+        Columns<Ts...> ParseSchema(const std::string& file_name, unsigned threads, Schema<Ts...>)
+        {
+            static_assert((is_schema_field<Ts> && ...), "schema fields are numbers, std::string_view or std::string");
+
+            Columns<Ts...> data;
+            const char* first;
+            const char* last;
+
+            auto file = std::make_shared<MappedFile>(file_name);
+
+            if (file->is_open())
+            {
+                first = file->data();
+                last = first + file->size();
+                data.text = file;
+            }
+            else
+            {
+                std::ifstream input(file_name, std::ios::binary);
+
+                // make sure file is valid
+                if (!input.good()) return data;
+
+                auto text = std::make_shared<std::vector<char>>(std::istreambuf_iterator<char>(input),
+                                                                std::istreambuf_iterator<char>());
+
+                first = text->data();
+                last = first + text->size();
+                data.text = text;
+            }
+
+            MappedLines lines(first, last);
+
+            auto cases = ReadCaseCount(lines); // get the total number of cases to account for
+            auto chunks = SplitChunks(lines.position(), last, threads);
+
+            if (chunks.size() == 1)
+            {
+                data.case_offsets.reserve(cases + 1);
+                ParseRows(lines, cases, data);
+            }
+            else
+            {
+                std::vector<Columns<Ts...>> parts(chunks.size());
+                std::size_t taken = 0, total = 0;
+
+                RunParallel(chunks.size(), [&](std::size_t i)
+                {
+                    MappedLines chunk(chunks[i].first, chunks[i].second);
+
+                    ParseRows(chunk, cases, parts[i]);
+                });
+
+                // only the first cases count, like a single pass
+                data.case_offsets.clear();
+
+                for (auto& part : parts)
+                {
+                    const std::size_t take = std::min<std::size_t>(part.size(), cases - taken);
+                    const std::size_t rows = part.case_offsets[take];
+
+                    for (std::size_t k = 0; k < take; ++k)
+                        data.case_offsets.push_back(total + part.case_offsets[k]);
+
+                    std::apply([&](auto&... column)
+                    {
+                        std::apply([&](auto&... whole)
+                        {
+                            (whole.insert(whole.end(), std::make_move_iterator(column.begin()),
+                                          std::make_move_iterator(column.begin() + static_cast<std::ptrdiff_t>(rows))), ...);
+                        }, data.columns);
+                    }, part.columns);
+
+                    total += rows;
+                    taken += take;
+                }
+
+                data.case_offsets.push_back(total);
+            }
+
+            // nothing points into the text, let it go
+            if constexpr (!(std::is_same_v<Ts, std::string_view> || ...))
+                data.text.reset();
+
+            return data;
+        }
+    }
+
+    /**
+     * @brief Returns a vector of vector of data. Numbers (other than bool
+     *        and characters) are read straight out of the mapped file with
+     *        from_chars, giving the same results as ParseStream; anything
+     *        else goes through ParseStream. Given threads, numbers are
+     *        parsed in pieces split on case boundaries, one thread each.
+     *        Given a Schema, each line is read as a row of fields instead,
+     *        into one column per field (see Columns).
+     *
+     * @param file_name
+     * @param threads (0 = one per core)
+     */
+    template <typename T>
+    typename detail::ParseResult<T>::type Parse(const std::string& file_name, unsigned threads = 1)
+    {
+        if constexpr (detail::is_schema<T>)
+        {
+            return detail::ParseSchema(file_name, threads, T());
+        }
+        else
+        {
+            if constexpr (detail::is_fast_parsable<T>)
+            {
+                detail::MappedFile file(file_name);
+
+                if (file.is_open())
+                    return detail::ParseMapped<T>(file, threads);
+            }
+
+            return ParseStream<T>(file_name);
+        }
+    }
+
+    /**
+     * @brief How a file is read when it's read rather than mapped.
+     *
+     */
+    struct ReadOptions
+    {
+        // bytes per read (and the line buffer's starting size)
+        std::size_t buffer_size = 1 << 20;
+        // reads kept in flight on a background thread, so reading and
+        // parsing overlap (0 = read in between parsing)
+        unsigned read_ahead = 0;
+    };
+
+    /**
+     * @brief Parses one case at a time, handing each to visit as soon as
+     *        it's complete. The file is read through a buffer of
+     *        buffer_size bytes and every case goes into the same vector,
+     *        so memory is bounded by the longest line and the largest case,
+     *        not the file (plus read_ahead more buffers, if set). Cases are
+     *        split as in Parse.
+     *
+     * @tparam T
+     * @tparam Visitor (called with std::vector<T>&, returning false stops if it returns bool)
+     * @param file_name
+     * @param visit
+     * @param options
+     * @return std::size_t (the number of cases visited)
+     */
+    template <typename T, typename Visitor>
+    std::size_t ParseEach(const std::string& file_name, Visitor&& visit, const ReadOptions& options)
+    {
+        detail::LineReader reader(file_name, options.buffer_size, options.read_ahead);
+        std::vector<T> values;
+        std::size_t visited = 0;
+        bool open = false, going = true;
+
+        // hands over the finished case, returns whether to go on
+        auto finish = [&]() -> bool
+        {
+            ++visited;
+
+            if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, std::vector<T>&>, bool>)
+                return visit(values);
+            else
+            {
+                visit(values);
+                return true;
+            }
+        };
+
+        // make sure file is valid
+        if (!reader.is_open()) return 0;
+
+        auto cases = detail::ReadCaseCount(reader); // get the total number of cases to account for
+
+        detail::SplitCases(reader, cases,
+                           [&]()
+                           {
+                               // a new case finishes the one before it
+                               if (open && !(going = finish())) return false;
+
+                               values.clear();
+                               open = true;
+                               return true;
+                           },
+                           [&](const char* first, const char* last) { detail::ParseLine(first, last, values); });
+
+        if (open && going) finish();
+
+        return visited;
+    }
+
+    /**
+     * @brief Parses one case at a time through a buffer of buffer_size
+     *        bytes (see above).
+     *
+     * @tparam T
+     * @tparam Visitor
+     * @param file_name
+     * @param visit
+     * @param buffer_size
+     * @return std::size_t (the number of cases visited)
+     */
+    template <typename T, typename Visitor>
+    std::size_t ParseEach(const std::string& file_name, Visitor&& visit, std::size_t buffer_size = 1 << 20)
+    {
+        return ParseEach<T>(file_name, std::forward<Visitor>(visit), ReadOptions{buffer_size, 0});
+    }
+
+    /**
+     * @brief Returns a vector of vector of data like Parse, but reads the
+     *        file through buffers instead of mapping it. With read_ahead
+     *        set, the next reads are already under way while a buffer is
+     *        parsed, which helps most when the file isn't cached yet.
+     *
+     * @tparam T
+     * @param file_name
+     * @param options
+     */
+    template <typename T>
+    std::vector<std::vector<T>> Parse(const std::string& file_name, const ReadOptions& options)
+    {
+        static_assert(!detail::is_schema<T>, "schemas are parsed out of a mapped file");
+
+        // data to create
+        std::vector<std::vector<T>> data;
+
+        ParseEach<T>(file_name, [&](std::vector<T>& values) { data.push_back(std::move(values)); }, options);
+
+        return data;
+    }
+
+    /**
+     * @brief Parses every case into one array of values, with an offset
+     *        array marking where each case starts. Numbers come straight
+     *        out of the mapped file, into an array reserved up front from a
+     *        sample of the file; anything else is read through a buffer.
+     *        Cases are split as in Parse. Given threads, numbers are parsed
+     *        in pieces split on case boundaries, then copied into place in
+     *        parallel.
+     *
+     * @tparam T
+     * @param file_name
+     * @param threads (0 = one per core)
+     * @return FlatCases<T>
+     */
+    template <typename T>
+    FlatCases<T> ParseFlat(const std::string& file_name, unsigned threads = 1)
+    {
+        FlatCases<T> data;
+
+        // fills in cases from lines past the count
+        auto parse = [](auto& lines, unsigned long cases, FlatCases<T>& part)
+        {
+            part.case_offsets.clear();
+
+            detail::SplitCases(lines, cases,
+                               [&]() { part.case_offsets.push_back(part.values.size()); return true; },
+                               [&](const char* first, const char* last) { detail::ParseLine(first, last, part.values); });
+
+            part.case_offsets.push_back(part.values.size());
+        };
+
+        if constexpr (detail::is_fast_parsable<T>)
+        {
+            detail::MappedFile file(file_name);
+
+            if (file.is_open())
+            {
+                detail::MappedLines lines(file.data(), file.data() + file.size());
+
+                auto cases = detail::ReadCaseCount(lines); // get the total number of cases to account for
+                auto chunks = detail::SplitChunks(lines.position(), file.data() + file.size(), threads);
+
+                if (chunks.size() == 1)
+                {
+                    data.values.reserve(detail::EstimateValues(file.data(), file.data() + file.size()));
+                    data.case_offsets.reserve(cases + 1);
+                    parse(lines, cases, data);
+
+                    return data;
+                }
+
+                std::vector<FlatCases<T>> parts(chunks.size());
+                std::vector<std::size_t> bases(chunks.size()), counts(chunks.size());
+                std::size_t taken = 0, total = 0;
+
+                detail::RunParallel(chunks.size(), [&](std::size_t i)
+                {
+                    detail::MappedLines chunk(chunks[i].first, chunks[i].second);
+
+                    parts[i].values.reserve(detail::EstimateValues(chunks[i].first, chunks[i].second));
+                    parse(chunk, cases, parts[i]);
+                });
+
+                // only the first cases count, like a single pass
+                data.case_offsets.clear();
+
+                for (std::size_t i = 0; i < parts.size(); ++i)
+                {
+                    std::size_t take = std::min<std::size_t>(parts[i].size(), cases - taken);
+
+                    for (std::size_t k = 0; k < take; ++k)
+                        data.case_offsets.push_back(total + parts[i].case_offsets[k]);
+
+                    bases[i] = total;
+                    counts[i] = parts[i].case_offsets[take];
+                    total += counts[i];
+                    taken += take;
+                }
+
+                data.case_offsets.push_back(total);
+                data.values.resize(total);
+
+                detail::RunParallel(parts.size(), [&](std::size_t i)
+                {
+                    std::copy(parts[i].values.begin(), parts[i].values.begin() + counts[i], data.values.begin() + bases[i]);
+                });
+
+                return data;
+            }
+        }
+
+        detail::LineReader reader(file_name, 1 << 20);
+
+        // make sure file is valid
+        if (reader.is_open())
+        {
+            auto cases = detail::ReadCaseCount(reader); // get the total number of cases to account for
+
+            data.case_offsets.reserve(cases + 1);
+            parse(reader, cases, data);
+        }
+
+        return data;
+    }
+
+    namespace detail
+    {
+        // bumped whenever the cache layout changes
+        constexpr std::uint32_t cache_version = 1;
+        // reads back differently on a machine with the other byte order
+        constexpr std::uint32_t cache_endian = 0x01020304;
+        // bytes before the values, so they start aligned
+        constexpr std::size_t cache_header_size = 128;
+
+        /**
+         * @brief What a cache file starts with. The values follow, then the
+         *        case offsets (on an 8 byte boundary).
+         *
+         */
+        struct CacheHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t endian;
+            // T: its size, and whether it's unsigned (0), signed (1) or floating (2)
+            std::uint32_t value_size;
+            std::uint32_t value_kind;
+            std::uint32_t offset_size;
+            std::uint32_t reserved;
+            // the text file it was parsed from, as it was then
+            std::uint64_t source_size;
+            std::int64_t source_seconds;
+            std::int64_t source_nanoseconds;
+            std::uint64_t cases;
+            std::uint64_t values;
+            // of everything past the header
+            std::uint64_t checksum;
+        };
+
+        static_assert(sizeof(CacheHeader) <= cache_header_size, "the cache header outgrew its space");
+
+        /**
+         * @brief Fills in the fields of a header that depend on T and the
+         *        machine.
+         *
+         * @tparam T
+         */
+        template <typename T>
+        CacheHeader MakeCacheHeader() noexcept
+        {
+            CacheHeader header{};
+
+            std::memcpy(header.magic, "IPCACHE", 8);
+            header.version = cache_version;
+            header.endian = cache_endian;
+            header.value_size = sizeof(T);
+            header.value_kind = std::is_floating_point_v<T> ? 2 : std::is_signed_v<T> ? 1 : 0;
+            header.offset_size = sizeof(std::size_t);
+
+            return header;
+        }
+
+        /**
+         * @brief Gets the size and modification time of a file.
+         *
+         * @param file_name
+         * @param header (receives them in its source fields)
+         * @return true
+         * @return false (no such file, or no way to tell)
+         */
+        inline bool StampSource(const std::string& file_name, CacheHeader& header) noexcept
+        {
+#ifdef INPUTPARSE_MMAP
+            struct stat info;
+
+            if (stat(file_name.c_str(), &info)) return false;
+
+            header.source_size = static_cast<std::uint64_t>(info.st_size);
+            header.source_seconds = static_cast<std::int64_t>(info.st_mtime);
+#ifdef __APPLE__
+            header.source_nanoseconds = static_cast<std::int64_t>(info.st_mtimespec.tv_nsec);
+#else
+            header.source_nanoseconds = static_cast<std::int64_t>(info.st_mtim.tv_nsec);
+#endif
+
+            return true;
+#else
+            (void)file_name; (void)header;
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Hashes bytes eight at a time. Catches a cache file that was
+         *        cut short or damaged, nothing more.
+         *
+         * @param data
+         * @param size (a multiple of 8)
+         * @param hash (the hash so far)
+         * @return std::uint64_t
+         */
+        inline std::uint64_t Checksum(const char* data, std::size_t size, std::uint64_t hash = 0) noexcept
+        {
+            std::uint64_t word;
+
+            for (std::size_t i = 0; i < size; i += 8)
+            {
+                std::memcpy(&word, data + i, 8);
+                hash = (hash ^ word) * 0x9E3779B97F4A7C15;
+                hash ^= hash >> 29;
+            }
+
+            return hash;
+        }
+
+        // bytes of values, padded so the offsets after them line up
+        inline std::size_t CacheValueBytes(std::size_t values, std::size_t value_size) noexcept
+        {
+            return (values * value_size + 7) & ~std::size_t(7);
+        }
+
+        /**
+         * @brief Writes a cache file next to where it goes, then moves it
+         *        into place, so nobody maps a half written one.
+         *
+         * @tparam T
+         * @param cache_name
+         * @param header (with the source fields filled in)
+         * @param data
+         * @return true
+         * @return false (it couldn't be written, nothing is left behind)
+         */
+        template <typename T>
+        bool WriteCache(const std::string& cache_name, CacheHeader header, const FlatCases<T>& data)
+        {
+#ifdef INPUTPARSE_MMAP
+            const std::string temp_name = cache_name + "." + std::to_string(getpid()) + ".tmp";
+            const char* values = reinterpret_cast<const char*>(data.values.data());
+            const char* offsets = reinterpret_cast<const char*>(data.case_offsets.data());
+            const std::size_t value_bytes = data.values.size() * sizeof(T);
+            const std::size_t offset_bytes = data.case_offsets.size() * sizeof(std::size_t);
+            // the values' last bytes padded out to eight
+            const std::size_t whole = value_bytes & ~std::size_t(7), tail_bytes = value_bytes == whole ? 0 : 8;
+            char tail[8] = {};
+            char block[cache_header_size] = {};
+
+            if (tail_bytes) std::memcpy(tail, values + whole, value_bytes - whole);
+
+            header.cases = data.size();
+            header.values = data.values.size();
+            header.checksum = Checksum(values, whole);
+            header.checksum = Checksum(tail, tail_bytes, header.checksum);
+            header.checksum = Checksum(offsets, offset_bytes, header.checksum);
+
+            std::memcpy(block, &header, sizeof(header));
+
+            {
+                std::ofstream output(temp_name, std::ios::binary | std::ios::trunc);
+
+                output.write(block, cache_header_size);
+                output.write(values, static_cast<std::streamsize>(whole));
+                output.write(tail, static_cast<std::streamsize>(tail_bytes));
+                output.write(offsets, static_cast<std::streamsize>(offset_bytes));
+                output.close();
+
+                if (output.fail())
+                {
+                    std::remove(temp_name.c_str());
+                    return false;
+                }
+            }
+
+            if (std::rename(temp_name.c_str(), cache_name.c_str()))
+            {
+                std::remove(temp_name.c_str());
+                return false;
+            }
+
+            return true;
+#else
+            (void)cache_name; (void)header; (void)data;
+            return false;
+#endif
+        }
+    }
+
+    /**
+     * @brief Cases as ParseCached hands them out: views into a mapped cache
+     *        file, or into values of its own when there's no cache to map.
+     *        Laid out like FlatCases.
+     *
+     * @tparam T
+     */
+    template <typename T>
+    class CachedCases
+    {
+    public:
+        CachedCases() = default;
+
+        /**
+         * @brief Takes parsed values, with no file behind them.
+         *
+         * @param data
+         */
+        explicit CachedCases(FlatCases<T>&& data) noexcept : owned_(std::move(data))
+        {
+            values_ = owned_.values.data();
+            offsets_ = owned_.case_offsets.data();
+            value_count_ = owned_.values.size();
+            cases_ = owned_.size();
+        }
+
+        /**
+         * @brief Checks a mapped cache file against what it should hold and
+         *        views the values in it.
+         *
+         * @param file
+         * @param expected (the header the file should start with, less its counts and checksum)
+         * @return true
+         * @return false (the file is stale or damaged, nothing changes)
+         */
+        bool Map(std::unique_ptr<detail::MappedFile> file, const detail::CacheHeader& expected) noexcept
+        {
+            detail::CacheHeader header;
+            std::size_t value_bytes, size;
+
+            if (!file->is_open() || file->size() < detail::cache_header_size) return false;
+
+            std::memcpy(&header, file->data(), sizeof(header));
+
+            // the same T on the same kind of machine, parsed from the file as it is now
+            if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) ||
+                header.version != expected.version || header.endian != expected.endian ||
+                header.value_size != expected.value_size || header.value_kind != expected.value_kind ||
+                header.offset_size != expected.offset_size || header.source_size != expected.source_size ||
+                header.source_seconds != expected.source_seconds ||
+                header.source_nanoseconds != expected.source_nanoseconds)
+                return false;
+
+            // the counts have to add up to exactly the file
+            size = file->size() - detail::cache_header_size;
+
+            if (header.values > size / sizeof(T) || header.cases >= size / sizeof(std::size_t)) return false;
+
+            value_bytes = detail::CacheValueBytes(static_cast<std::size_t>(header.values), sizeof(T));
+
+            if (size != value_bytes + (static_cast<std::size_t>(header.cases) + 1) * sizeof(std::size_t) ||
+                detail::Checksum(file->data() + detail::cache_header_size, size) != header.checksum)
+                return false;
+
+            auto offsets = reinterpret_cast<const std::size_t*>(file->data() + detail::cache_header_size + value_bytes);
+
+            // every case has to be inside the values
+            if (offsets[0] || offsets[header.cases] != header.values) return false;
+
+            for (std::size_t i = 0; i < header.cases; ++i)
+                if (offsets[i] > offsets[i + 1]) return false;
+
+            values_ = reinterpret_cast<const T*>(file->data() + detail::cache_header_size);
+            offsets_ = offsets;
+            value_count_ = static_cast<std::size_t>(header.values);
+            cases_ = static_cast<std::size_t>(header.cases);
+            owned_ = FlatCases<T>();
+            file_ = std::move(file);
+
+            return true;
+        }
+
+        std::size_t size() const noexcept { return cases_; }
+        bool empty() const noexcept { return !cases_; }
+        // whether the values are in a mapped cache file
+        bool mapped() const noexcept { return file_ != nullptr; }
+
+        Span<const T> values() const noexcept { return Span<const T>(values_, value_count_); }
+        Span<const std::size_t> case_offsets() const noexcept { return Span<const std::size_t>(offsets_, cases_ + 1); }
+
+        Span<const T> operator[](std::size_t index) const noexcept
+        {
+            return Span<const T>(values_ + offsets_[index], offsets_[index + 1] - offsets_[index]);
+        }
+
+    private:
+        // one or the other keeps the values alive
+        std::unique_ptr<detail::MappedFile> file_;
+        FlatCases<T> owned_;
+
+        const T* values_ = nullptr;
+        const std::size_t* offsets_ = owned_.case_offsets.data();
+        std::size_t value_count_ = 0;
+        std::size_t cases_ = 0;
+    };
+
+    /**
+     * @brief Parses a file as in ParseFlat the first time, saving the result
+     *        to a binary cache file beside it. Later calls map the cache
+     *        and hand out views into it, with nothing parsed at all, as long
+     *        as the text file is the size it was and hasn't been modified
+     *        since (otherwise it's parsed and cached again). Mapping checks
+     *        a checksum over the whole cache, so a damaged one reads as
+     *        stale. Freshly parsed values are handed out as they are, and
+     *        are all there is where the cache can't be written (or there's
+     *        no mmap).
+     *
+     * @tparam T
+     * @param file_name
+     * @param threads (0 = one per core, only used when parsing)
+     * @param cache_name (empty = file_name + ".cache")
+     * @return CachedCases<T>
+     */
+    template <typename T>
+    CachedCases<T> ParseCached(const std::string& file_name, unsigned threads = 1, std::string cache_name = std::string())
+    {
+        static_assert(detail::is_fast_parsable<T>, "only numbers are cached");
+
+        detail::CacheHeader header = detail::MakeCacheHeader<T>();
+        CachedCases<T> data;
+
+        if (cache_name.empty()) cache_name = file_name + ".cache";
+
+        // no source file, nothing to cache (or parse)
+        if (!detail::StampSource(file_name, header)) return CachedCases<T>(ParseFlat<T>(file_name, threads));
+
+        if (data.Map(std::make_unique<detail::MappedFile>(cache_name), header)) return data;
+
+        // stamped before parsing, so a change while it's read shows up next time
+        auto parsed = ParseFlat<T>(file_name, threads);
+
+        // the values are at hand already, the cache is for next time
+        detail::WriteCache(cache_name, header, parsed);
+
+        return CachedCases<T>(std::move(parsed));
+    }
 }
@@ -0,0 +1,252 @@
+/******************************************************************************/
+/*
+* @file   inputparse_simd.h
+* @author Aditya Harsh
+* @brief  Byte classification and short decimal decoding for the InputParse
+*         tokenizer. Picks AVX2, SSE2 or plain C at runtime.
+*/
+/******************************************************************************/
+
+#pragma once
+
+#include <cstdint>      /* std::uint64_t, std::uint32_t     */
+#include <cstring>      /* std::memcpy                      */
+#include <cstddef>      /* std::size_t                      */
+
+// x86 classifiers, the rest of the world gets the scalar loop
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define INPUTPARSE_X86
+#define INPUTPARSE_SSE2 __attribute__((target("sse2")))
+#define INPUTPARSE_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace InputParse
+{
+    namespace detail
+    {
+        // bytes classified at once
+        constexpr std::size_t block_size = 64;
+
+        /**
+         * @brief Bit i describes byte i of a block.
+         *
+         */
+        struct BlockMasks
+        {
+            // '\n'
+            std::uint64_t newlines;
+            // what operator>> skips: ' ', '\t', '\n', '\v', '\f', '\r'
+            std::uint64_t spaces;
+        };
+
+        /**
+         * @brief Classifies a block a byte at a time.
+         *
+         * @param block (block_size bytes)
+         */
+        inline BlockMasks ClassifyScalar(const char* block) noexcept
+        {
+            BlockMasks masks{0, 0};
+
+            for (std::size_t i = 0; i < block_size; ++i)
+            {
+                const unsigned char c = static_cast<unsigned char>(block[i]);
+
+                masks.newlines |= std::uint64_t(c == '\n') << i;
+                masks.spaces |= std::uint64_t(c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t') << i;
+            }
+
+            return masks;
+        }
+
+#ifdef INPUTPARSE_X86
+        /**
+         * @brief Classifies a block 16 bytes at a time.
+         *
+         * @param block (block_size bytes)
+         */
+        INPUTPARSE_SSE2 inline BlockMasks ClassifySse2(const char* block) noexcept
+        {
+            const __m128i newline = _mm_set1_epi8('\n');
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i controls = _mm_set1_epi8('\r' - '\t');
+            BlockMasks masks{0, 0};
+
+            for (std::size_t i = 0; i < block_size; i += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+
+                // '\t' to '\r' is one unsigned range: (c - '\t') <= 4
+                __m128i offset = _mm_sub_epi8(bytes, tab);
+                __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, controls), offset);
+                __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(bytes, space), control);
+
+                masks.newlines |= std::uint64_t(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << i;
+                masks.spaces |= std::uint64_t(static_cast<unsigned>(_mm_movemask_epi8(spaces))) << i;
+            }
+
+            return masks;
+        }
+
+        /**
+         * @brief Classifies a block 32 bytes at a time.
+         *
+         * @param block (block_size bytes)
+         */
+        INPUTPARSE_AVX2 inline BlockMasks ClassifyAvx2(const char* block) noexcept
+        {
+            const __m256i newline = _mm256_set1_epi8('\n');
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i controls = _mm256_set1_epi8('\r' - '\t');
+            BlockMasks masks{0, 0};
+
+            for (std::size_t i = 0; i < block_size; i += 32)
+            {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+
+                __m256i offset = _mm256_sub_epi8(bytes, tab);
+                __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, controls), offset);
+                __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), control);
+
+                masks.newlines |= std::uint64_t(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline)))) << i;
+                masks.spaces |= std::uint64_t(static_cast<unsigned>(_mm256_movemask_epi8(spaces))) << i;
+            }
+
+            return masks;
+        }
+#endif
+
+        /**
+         * @brief Returns the index of the lowest set bit.
+         *
+         * @param bits (not 0)
+         */
+        inline unsigned TrailingZeros(std::uint64_t bits) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+            unsigned count = 0;
+
+            for (; !(bits & 1); bits >>= 1)
+                ++count;
+
+            return count;
+#endif
+        }
+
+        using ClassifyFunc = BlockMasks (*)(const char*) noexcept;
+
+        /**
+         * @brief Picks the widest classifier the CPU runs.
+         *
+         */
+        inline ClassifyFunc PickClassify() noexcept
+        {
+#ifdef INPUTPARSE_X86
+            if (__builtin_cpu_supports("avx2")) return ClassifyAvx2;
+            if (__builtin_cpu_supports("sse2")) return ClassifySse2;
+#endif
+
+            return ClassifyScalar;
+        }
+
+        /**
+         * @brief Classifies the bytes from block to last, up to block_size of
+         *        them. Bytes past last read as spaces. A short block at the
+         *        end is read as the last block_size bytes before last when
+         *        those are there, and copied out only when they aren't.
+         *
+         * @param first (where the readable bytes start, at or before block)
+         * @param block
+         * @param last
+         */
+        inline BlockMasks Classify(const char* first, const char* block, const char* last) noexcept
+        {
+            static const ClassifyFunc classify = PickClassify();
+            const std::size_t size = static_cast<std::size_t>(last - block);
+            BlockMasks masks;
+
+            if (size >= block_size) return classify(block);
+
+            if (static_cast<std::size_t>(last - first) >= block_size)
+            {
+                // shift out the bytes before block
+                masks = classify(last - block_size);
+                masks.newlines >>= block_size - size;
+                masks.spaces >>= block_size - size;
+            }
+            else
+            {
+                char padded[block_size];
+
+                std::memcpy(padded, block, size);
+                masks = classify(padded);
+            }
+
+            masks.newlines &= (std::uint64_t(1) << size) - 1;
+            masks.spaces |= ~std::uint64_t(0) << size;
+
+            return masks;
+        }
+
+        /**
+         * @brief Reads up to eight leading decimal digits at once, all in
+         *        one 64 bit register (SIMD within a register): finds where
+         *        the digits stop, then folds pairs, quads and octets of
+         *        digits together with three multiplies.
+         *
+         * @param first
+         * @param last
+         * @param value
+         * @return std::size_t (the number of digits, 0 if there are none or
+         *                      more than eight)
+         */
+        inline std::size_t DecodeShortDecimal(const char* first, const char* last, std::uint32_t& value) noexcept
+        {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            std::uint64_t bytes, digits, others;
+            std::size_t count;
+
+            // a fixed size load, the last few bytes of a file go the slow way
+            if (last - first < 8) return 0;
+
+            std::memcpy(&bytes, first, 8);
+
+            // a byte is a digit if its high nibble is 3 before and after adding 6
+            others = ((bytes & 0xF0F0F0F0F0F0F0F0) | (((bytes + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ^
+                     0x3333333333333333;
+
+            if (!others)
+            {
+                // a ninth digit is too many
+                if (last - first > 8 && first[8] >= '0' && first[8] <= '9') return 0;
+                count = 8;
+            }
+            else
+            {
+                count = TrailingZeros(others) / 8;
+                if (!count) return 0;
+            }
+
+            // the digits as values, moved up so leading zeros fill the front
+            digits = count == 8 ? bytes : bytes & ((std::uint64_t(1) << (count * 8)) - 1);
+            digits = (digits - (0x3030303030303030 >> ((8 - count) * 8))) << ((8 - count) * 8);
+
+            digits = digits * 10 + (digits >> 8);
+            digits = (((digits & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+                      (((digits >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+
+            value = static_cast<std::uint32_t>(digits);
+
+            return count;
+#else
+            (void)first; (void)last; (void)value;
+            return 0;
+#endif
+        }
+    }
+}
@@ -8,6 +8,9 @@
 
 /* HOW TO USE
 - Place init_list(some type) on top your file
+- Or place init_compact_list(some type) instead, for lists of many small
+  elements: the nodes live in one growable array and link through 32-bit
+  indices, with erased nodes kept on a free list for reuse
 - Use the uniform functions to on the bottom of the file
 
     EXAMPLE:
@@ -32,7 +35,7 @@
 #pragma once
 
 #include <stdlib.h> /* malloc, free, NULL */
-#include <string.h> /* memset             */
+#include <string.h> /* memset, memcpy     */
 
 /* macro helper functions */
 #define PASTE(x, y) x ## _ ## y
@@ -41,9 +44,18 @@
 /* define list and node */
 #define list(type) EVALUATE(list,type)
 #define l_node(type) EVALUATE(l_node,type)
+#define c_node(type) EVALUATE(c_node,type)
+
+/* end of a compact list (no node) */
+#define LIST_NIL ((unsigned)-1)
+/* number of nodes in a compact list's first arena */
+#define LIST_MIN_CAPACITY 16
 
 /* define booleans */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
 typedef enum {false = 0, true = 1} bool;
+#endif
 
 /* call to setup the type */
 #define init_list(type)                                                                     \
@@ -339,6 +351,306 @@ void EVALUATE(erase_element_custom,list(type)) (list(type) * list, const type *
     }                                                                                       \
 }                                                                                           \
 
+/* call to setup the type (arena-backed nodes, same interface as init_list) */
+#define init_compact_list(type)                                                             \
+                                                                                            \
+typedef struct c_node(type) c_node(type);                                                   \
+typedef void (*EVALUATE(call_back,type)) (type*);                                           \
+typedef bool (*compare)(const type*, const type*);                                          \
+                                                                                            \
+struct c_node(type)                                                                         \
+{                                                                                           \
+    type data_;                                                                             \
+    unsigned next_;                                                                         \
+};                                                                                          \
+                                                                                            \
+typedef struct                                                                              \
+{                                                                                           \
+    c_node(type) * nodes_;                                                                  \
+    unsigned capacity_;                                                                     \
+    unsigned used_;                                                                         \
+    unsigned free_;                                                                         \
+    unsigned head_;                                                                         \
+    unsigned tail_;                                                                         \
+    unsigned size_;                                                                         \
+} list(type);                                                                               \
+                                                                                            \
+list(type) EVALUATE(create,list(type)) (void)                                               \
+{                                                                                           \
+    list(type) list = {NULL, 0, 0, LIST_NIL, LIST_NIL, LIST_NIL, 0};                        \
+    return list;                                                                            \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(clear,list(type)) (list(type) * list)                                         \
+{                                                                                           \
+    if (!list) return;                                                                      \
+                                                                                            \
+    free(list->nodes_);                                                                     \
+                                                                                            \
+    *list = EVALUATE(create,list(type))();                                                  \
+}                                                                                           \
+                                                                                            \
+unsigned EVALUATE(alloc_node,list(type)) (list(type) * list)                                \
+{                                                                                           \
+    c_node(type) * nodes;                                                                   \
+    unsigned index, capacity;                                                               \
+                                                                                            \
+    if (list->free_ != LIST_NIL)                                                            \
+    {                                                                                       \
+        index = list->free_;                                                                \
+        list->free_ = list->nodes_[index].next_;                                            \
+        return index;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    if (list->used_ == list->capacity_)                                                     \
+    {                                                                                       \
+        capacity = list->capacity_ ? list->capacity_ * 2 : LIST_MIN_CAPACITY;               \
+        nodes = realloc(list->nodes_, sizeof(c_node(type)) * capacity);                     \
+        if (!nodes) return LIST_NIL;                                                        \
+        list->nodes_ = nodes;                                                               \
+        list->capacity_ = capacity;                                                         \
+    }                                                                                       \
+                                                                                            \
+    return list->used_++;                                                                   \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(free_node,list(type)) (list(type) * list, unsigned index)                     \
+{                                                                                           \
+    list->nodes_[index].next_ = list->free_;                                                \
+    list->free_ = index;                                                                    \
+    --list->size_;                                                                          \
+                                                                                            \
+    if (!list->size_)                                                                       \
+    {                                                                                       \
+        list->used_ = 0;                                                                    \
+        list->free_ = LIST_NIL;                                                             \
+        list->head_ = LIST_NIL;                                                             \
+        list->tail_ = LIST_NIL;                                                             \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(push_back,list(type)) (list(type) * list, type value)                         \
+{                                                                                           \
+    unsigned index;                                                                         \
+                                                                                            \
+    if (!list) return;                                                                      \
+                                                                                            \
+    index = EVALUATE(alloc_node,list(type))(list);                                          \
+    if (index == LIST_NIL) return;                                                          \
+                                                                                            \
+    list->nodes_[index].data_ = value;                                                      \
+    list->nodes_[index].next_ = LIST_NIL;                                                   \
+                                                                                            \
+    if (list->tail_ != LIST_NIL)                                                            \
+        list->nodes_[list->tail_].next_ = index;                                            \
+    else                                                                                    \
+        list->head_ = index;                                                                \
+                                                                                            \
+    list->tail_ = index;                                                                    \
+    ++list->size_;                                                                          \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(push_front,list(type)) (list(type) * list, type value)                        \
+{                                                                                           \
+    unsigned index;                                                                         \
+                                                                                            \
+    if (!list) return;                                                                      \
+                                                                                            \
+    index = EVALUATE(alloc_node,list(type))(list);                                          \
+    if (index == LIST_NIL) return;                                                          \
+                                                                                            \
+    list->nodes_[index].data_ = value;                                                      \
+    list->nodes_[index].next_ = list->head_;                                                \
+                                                                                            \
+    if (list->head_ == LIST_NIL)                                                            \
+        list->tail_ = index;                                                                \
+                                                                                            \
+    list->head_ = index;                                                                    \
+    ++list->size_;                                                                          \
+}                                                                                           \
+                                                                                            \
+type EVALUATE(get,list(type)) (const list(type) * list, unsigned index)                     \
+{                                                                                           \
+    type garbage;                                                                           \
+    unsigned curr, i;                                                                       \
+                                                                                            \
+    memset(&garbage, 0, sizeof(type));                                                      \
+                                                                                            \
+    if (!list || index >= list->size_) return garbage;                                      \
+                                                                                            \
+    curr = list->head_;                                                                     \
+                                                                                            \
+    for (i = 0; i < index; ++i)                                                             \
+        curr = list->nodes_[curr].next_;                                                    \
+                                                                                            \
+    return list->nodes_[curr].data_;                                                        \
+}                                                                                           \
+                                                                                            \
+unsigned EVALUATE(size,list(type)) (const list(type) * list)                                \
+{                                                                                           \
+    if (!list) return 0;                                                                    \
+                                                                                            \
+    return list->size_;                                                                     \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(pop_back,list(type)) (list(type) * list)                                      \
+{                                                                                           \
+    unsigned prev;                                                                          \
+                                                                                            \
+    if (!list || list->tail_ == LIST_NIL) return;                                           \
+                                                                                            \
+    if (list->head_ == list->tail_)                                                         \
+    {                                                                                       \
+        EVALUATE(free_node,list(type))(list, list->tail_);                                  \
+        return;                                                                             \
+    }                                                                                       \
+                                                                                            \
+    prev = list->head_;                                                                     \
+                                                                                            \
+    while (list->nodes_[prev].next_ != list->tail_)                                         \
+        prev = list->nodes_[prev].next_;                                                    \
+                                                                                            \
+    EVALUATE(free_node,list(type))(list, list->tail_);                                      \
+    list->nodes_[prev].next_ = LIST_NIL;                                                    \
+    list->tail_ = prev;                                                                     \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(pop_front,list(type)) (list(type) * list)                                     \
+{                                                                                           \
+    unsigned next;                                                                          \
+                                                                                            \
+    if (!list || list->head_ == LIST_NIL) return;                                           \
+                                                                                            \
+    next = list->nodes_[list->head_].next_;                                                 \
+                                                                                            \
+    EVALUATE(free_node,list(type))(list, list->head_);                                      \
+                                                                                            \
+    if (list->size_)                                                                        \
+        list->head_ = next;                                                                 \
+}                                                                                           \
+                                                                                            \
+type EVALUATE(front,list(type)) (const list(type) * list)                                   \
+{                                                                                           \
+    type garbage;                                                                           \
+    memset(&garbage, 0, sizeof(type));                                                      \
+    if (!list || list->head_ == LIST_NIL) return garbage;                                   \
+                                                                                            \
+    return list->nodes_[list->head_].data_;                                                 \
+}                                                                                           \
+                                                                                            \
+type EVALUATE(back,list(type)) (const list(type) * list)                                    \
+{                                                                                           \
+    type garbage;                                                                           \
+    memset(&garbage, 0, sizeof(type));                                                      \
+    if (!list || list->tail_ == LIST_NIL) return garbage;                                   \
+                                                                                            \
+    return list->nodes_[list->tail_].data_;                                                 \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(copy,list(type)) (list(type) * dest, const list(type) * source)               \
+{                                                                                           \
+    c_node(type) * nodes = NULL;                                                            \
+                                                                                            \
+    if (!dest || !source || dest == source) return;                                         \
+                                                                                            \
+    if (source->used_)                                                                      \
+    {                                                                                       \
+        nodes = malloc(sizeof(c_node(type)) * source->used_);                               \
+        if (!nodes) return;                                                                 \
+        memcpy(nodes, source->nodes_, sizeof(c_node(type)) * source->used_);                \
+    }                                                                                       \
+                                                                                            \
+    free(dest->nodes_);                                                                     \
+                                                                                            \
+    *dest = *source;                                                                        \
+    dest->nodes_ = nodes;                                                                   \
+    dest->capacity_ = source->used_;                                                        \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(foreach,list(type)) (list(type) * list, EVALUATE(call_back,type) cb)          \
+{                                                                                           \
+    unsigned curr;                                                                          \
+                                                                                            \
+    if (!list) return;                                                                      \
+                                                                                            \
+    for (curr = list->head_; curr != LIST_NIL; curr = list->nodes_[curr].next_)             \
+        cb(&list->nodes_[curr].data_);                                                      \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(reverse,list(type)) (list(type) * list)                                       \
+{                                                                                           \
+    unsigned prev = LIST_NIL;                                                               \
+    unsigned next;                                                                          \
+    unsigned curr;                                                                          \
+                                                                                            \
+    if (!list || list->head_ == LIST_NIL) return;                                           \
+                                                                                            \
+    curr = list->head_;                                                                     \
+    list->tail_ = curr;                                                                     \
+                                                                                            \
+    while (curr != LIST_NIL)                                                                \
+    {                                                                                       \
+        next = list->nodes_[curr].next_;                                                    \
+        list->nodes_[curr].next_ = prev;                                                    \
+        prev = curr;                                                                        \
+        curr = next;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    list->head_ = prev;                                                                     \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(unlink,list(type)) (list(type) * list, unsigned prev, unsigned curr)          \
+{                                                                                           \
+    unsigned next = list->nodes_[curr].next_;                                               \
+                                                                                            \
+    if (prev == LIST_NIL)                                                                   \
+        list->head_ = next;                                                                 \
+    else                                                                                    \
+        list->nodes_[prev].next_ = next;                                                    \
+                                                                                            \
+    if (curr == list->tail_)                                                                \
+        list->tail_ = prev;                                                                 \
+                                                                                            \
+    EVALUATE(free_node,list(type))(list, curr);                                             \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(erase_element,list(type)) (list(type) * list, type value)                     \
+{                                                                                           \
+    unsigned prev = LIST_NIL;                                                               \
+    unsigned curr;                                                                          \
+                                                                                            \
+    if (!list) return;                                                                      \
+                                                                                            \
+    for (curr = list->head_; curr != LIST_NIL; curr = list->nodes_[curr].next_)             \
+    {                                                                                       \
+        if (list->nodes_[curr].data_ == value)                                              \
+        {                                                                                   \
+            EVALUATE(unlink,list(type))(list, prev, curr);                                  \
+            break;                                                                          \
+        }                                                                                   \
+        prev = curr;                                                                        \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(erase_element_custom,list(type)) (list(type) * list, const type * value,      \
+             compare comp)                                                                  \
+{                                                                                           \
+    unsigned prev = LIST_NIL;                                                               \
+    unsigned curr;                                                                          \
+                                                                                            \
+    if (!list || !value) return;                                                            \
+                                                                                            \
+    for (curr = list->head_; curr != LIST_NIL; curr = list->nodes_[curr].next_)             \
+    {                                                                                       \
+        if (comp(&list->nodes_[curr].data_, value))                                         \
+        {                                                                                   \
+            EVALUATE(unlink,list(type))(list, prev, curr);                                  \
+            break;                                                                          \
+        }                                                                                   \
+        prev = curr;                                                                        \
+    }                                                                                       \
+}                                                                                           \
+
 /* Uniform function call syntax for all lists */
 #define create_list(type) EVALUATE(create,list(type)) ()
 /* clears the list */
@@ -0,0 +1,356 @@
+/******************************************************************************/
+/*
+* @file   mpsc_queue.h
+* @author Aditya Harsh
+* @brief  Type-agnostic lock-free multi-producer single-consumer queue.
+*         Written in C11 (needs <stdatomic.h>).
+*/
+/******************************************************************************/
+
+/* HOW TO USE
+- Place init_mpsc_queue(some type) on top your file
+- Every producer thread makes its own producer with create_mpsc_producer and
+  pushes through it. Producers keep a private cache of free nodes, refilled
+  from the queue's pool in one atomic swap, so pushing doesn't malloc once
+  the pool is warm (nodes come in slabs of MPSC_SLAB_SIZE when it isn't).
+- Only one thread may pop/take_all. take_all hands every queued element to a
+  callback in FIFO order (per producer) and recycles the nodes in one go.
+- clear_mpsc_queue frees every slab; only call it once all producers are done.
+
+    EXAMPLE:
+        #include "mpsc_queue.h"
+
+        init_mpsc_queue(int)
+
+        void consume(int* value) { ... }
+
+        int main(void)
+        {
+            mpsc_queue(int) my_queue;
+            mpsc_producer(int) producer;
+            int value;
+
+            create_mpsc_queue(int, my_queue, 1024);
+
+            // on the producer threads
+            producer = create_mpsc_producer(int, my_queue);
+            push_mpsc_queue(int, producer, 1);
+            push_mpsc_queue(int, producer, 2);
+            release_mpsc_producer(int, producer);
+
+            // on the consumer thread
+            pop_mpsc_queue(int, my_queue, value);
+            take_all_mpsc_queue(int, my_queue, consume);
+
+            clear_mpsc_queue(int, my_queue);
+
+            return 0;
+        }
+ */
+
+#pragma once
+
+#include <stdlib.h>    /* malloc, free, NULL */
+#include <stdatomic.h> /* _Atomic, atomic_*  */
+
+/* macro helper functions */
+#define PASTE(x, y) x ## _ ## y
+#define EVALUATE(x, y) PASTE(x, y)
+
+/* define queue, producer, node and slab */
+#define mpsc_queue(type) EVALUATE(mpsc_queue,type)
+#define mpsc_producer(type) EVALUATE(mpsc_producer,type)
+#define m_node(type) EVALUATE(m_node,type)
+#define m_slab(type) EVALUATE(m_slab,type)
+
+/* define booleans */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+
+/* number of nodes allocated at once when the pool runs dry */
+#define MPSC_SLAB_SIZE 256
+
+/* call to setup the type */
+#define init_mpsc_queue(type)                                                               \
+                                                                                            \
+typedef struct m_node(type) m_node(type);                                                   \
+typedef struct m_slab(type) m_slab(type);                                                   \
+typedef void (*EVALUATE(call_back,type)) (type*);                                           \
+                                                                                            \
+struct m_node(type)                                                                         \
+{                                                                                           \
+    type data_;                                                                             \
+    m_node(type) * next_;                                                                   \
+};                                                                                          \
+                                                                                            \
+struct m_slab(type)                                                                         \
+{                                                                                           \
+    m_slab(type) * next_;                                                                   \
+    m_node(type) nodes_[MPSC_SLAB_SIZE];                                                    \
+};                                                                                          \
+                                                                                            \
+typedef struct                                                                              \
+{                                                                                           \
+    _Atomic(m_node(type) *) head_;                                                          \
+    _Atomic(m_node(type) *) pool_;                                                          \
+    _Atomic(m_slab(type) *) slabs_;                                                         \
+    m_node(type) * pending_;                                                                \
+    m_node(type) * retired_;                                                                \
+    m_node(type) * retired_last_;                                                           \
+} mpsc_queue(type);                                                                         \
+                                                                                            \
+typedef struct                                                                              \
+{                                                                                           \
+    mpsc_queue(type) * queue_;                                                              \
+    m_node(type) * cache_;                                                                  \
+} mpsc_producer(type);                                                                      \
+                                                                                            \
+void EVALUATE(recycle,mpsc_queue(type)) (mpsc_queue(type) * queue, m_node(type) * first,    \
+             m_node(type) * last)                                                           \
+{                                                                                           \
+    m_node(type) * pool = atomic_load_explicit(&queue->pool_, memory_order_relaxed);        \
+                                                                                            \
+    do                                                                                      \
+    {                                                                                       \
+        last->next_ = pool;                                                                 \
+    } while (!atomic_compare_exchange_weak_explicit(&queue->pool_, &pool, first,            \
+             memory_order_release, memory_order_relaxed));                                  \
+}                                                                                           \
+                                                                                            \
+m_node(type) * EVALUATE(alloc_slab,mpsc_queue(type)) (mpsc_queue(type) * queue)             \
+{                                                                                           \
+    m_slab(type) * slab = malloc(sizeof(m_slab(type)));                                     \
+    m_slab(type) * slabs;                                                                   \
+    unsigned i;                                                                             \
+                                                                                            \
+    if (!slab) return NULL;                                                                 \
+                                                                                            \
+    for (i = 0; i < MPSC_SLAB_SIZE - 1; ++i)                                                \
+        slab->nodes_[i].next_ = &slab->nodes_[i + 1];                                       \
+    slab->nodes_[MPSC_SLAB_SIZE - 1].next_ = NULL;                                          \
+                                                                                            \
+    slabs = atomic_load_explicit(&queue->slabs_, memory_order_relaxed);                     \
+                                                                                            \
+    do                                                                                      \
+    {                                                                                       \
+        slab->next_ = slabs;                                                                \
+    } while (!atomic_compare_exchange_weak_explicit(&queue->slabs_, &slabs, slab,           \
+             memory_order_release, memory_order_relaxed));                                  \
+                                                                                            \
+    return slab->nodes_;                                                                    \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(create,mpsc_queue(type)) (mpsc_queue(type) * queue, unsigned reserve)         \
+{                                                                                           \
+    m_node(type) * nodes;                                                                   \
+                                                                                            \
+    if (!queue) return false;                                                               \
+                                                                                            \
+    atomic_init(&queue->head_, NULL);                                                       \
+    atomic_init(&queue->pool_, NULL);                                                       \
+    atomic_init(&queue->slabs_, NULL);                                                      \
+    queue->pending_ = NULL;                                                                 \
+    queue->retired_ = NULL;                                                                 \
+    queue->retired_last_ = NULL;                                                            \
+                                                                                            \
+    for (; reserve; reserve -= reserve < MPSC_SLAB_SIZE ? reserve : MPSC_SLAB_SIZE)         \
+    {                                                                                       \
+        nodes = EVALUATE(alloc_slab,mpsc_queue(type))(queue);                               \
+        if (!nodes) return false;                                                           \
+        EVALUATE(recycle,mpsc_queue(type))(queue, nodes, nodes + MPSC_SLAB_SIZE - 1);       \
+    }                                                                                       \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(clear,mpsc_queue(type)) (mpsc_queue(type) * queue)                            \
+{                                                                                           \
+    m_slab(type) * slab;                                                                    \
+    m_slab(type) * next;                                                                    \
+                                                                                            \
+    if (!queue) return;                                                                     \
+                                                                                            \
+    slab = atomic_exchange_explicit(&queue->slabs_, NULL, memory_order_acquire);            \
+                                                                                            \
+    while (slab)                                                                            \
+    {                                                                                       \
+        next = slab->next_;                                                                 \
+        free(slab);                                                                         \
+        slab = next;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    atomic_store_explicit(&queue->head_, NULL, memory_order_relaxed);                       \
+    atomic_store_explicit(&queue->pool_, NULL, memory_order_relaxed);                       \
+    queue->pending_ = NULL;                                                                 \
+    queue->retired_ = NULL;                                                                 \
+    queue->retired_last_ = NULL;                                                            \
+}                                                                                           \
+                                                                                            \
+mpsc_producer(type) EVALUATE(create,mpsc_producer(type)) (mpsc_queue(type) * queue)         \
+{                                                                                           \
+    mpsc_producer(type) producer;                                                           \
+    producer.queue_ = queue;                                                                \
+    producer.cache_ = NULL;                                                                 \
+    return producer;                                                                        \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(release,mpsc_producer(type)) (mpsc_producer(type) * producer)                 \
+{                                                                                           \
+    m_node(type) * last;                                                                    \
+                                                                                            \
+    if (!producer || !producer->cache_) return;                                             \
+                                                                                            \
+    for (last = producer->cache_; last->next_; last = last->next_);                         \
+                                                                                            \
+    EVALUATE(recycle,mpsc_queue(type))(producer->queue_, producer->cache_, last);           \
+    producer->cache_ = NULL;                                                                \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(push,mpsc_queue(type)) (mpsc_producer(type) * producer, type value)           \
+{                                                                                           \
+    m_node(type) * node;                                                                    \
+    m_node(type) * head;                                                                    \
+                                                                                            \
+    if (!producer) return false;                                                            \
+                                                                                            \
+    if (!producer->cache_)                                                                  \
+    {                                                                                       \
+        producer->cache_ = atomic_exchange_explicit(&producer->queue_->pool_, NULL,         \
+                           memory_order_acquire);                                           \
+        if (!producer->cache_)                                                              \
+            producer->cache_ = EVALUATE(alloc_slab,mpsc_queue(type))(producer->queue_);     \
+        if (!producer->cache_) return false;                                                \
+    }                                                                                       \
+                                                                                            \
+    node = producer->cache_;                                                                \
+    producer->cache_ = node->next_;                                                         \
+    node->data_ = value;                                                                    \
+                                                                                            \
+    head = atomic_load_explicit(&producer->queue_->head_, memory_order_relaxed);            \
+                                                                                            \
+    do                                                                                      \
+    {                                                                                       \
+        node->next_ = head;                                                                 \
+    } while (!atomic_compare_exchange_weak_explicit(&producer->queue_->head_, &head, node,  \
+             memory_order_release, memory_order_relaxed));                                  \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+m_node(type) * EVALUATE(take,mpsc_queue(type)) (mpsc_queue(type) * queue)                   \
+{                                                                                           \
+    m_node(type) * curr;                                                                    \
+    m_node(type) * prev = NULL;                                                             \
+    m_node(type) * next;                                                                    \
+                                                                                            \
+    curr = atomic_exchange_explicit(&queue->head_, NULL, memory_order_acquire);             \
+                                                                                            \
+    while (curr)                                                                            \
+    {                                                                                       \
+        next = curr->next_;                                                                 \
+        curr->next_ = prev;                                                                 \
+        prev = curr;                                                                        \
+        curr = next;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    return prev;                                                                            \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(flush,mpsc_queue(type)) (mpsc_queue(type) * queue)                            \
+{                                                                                           \
+    if (!queue->retired_) return;                                                           \
+                                                                                            \
+    EVALUATE(recycle,mpsc_queue(type))(queue, queue->retired_, queue->retired_last_);       \
+    queue->retired_ = NULL;                                                                 \
+    queue->retired_last_ = NULL;                                                            \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(pop,mpsc_queue(type)) (mpsc_queue(type) * queue, type * value)                \
+{                                                                                           \
+    m_node(type) * node;                                                                    \
+                                                                                            \
+    if (!queue || !value) return false;                                                     \
+                                                                                            \
+    if (!queue->pending_)                                                                   \
+    {                                                                                       \
+        EVALUATE(flush,mpsc_queue(type))(queue);                                            \
+                                                                                            \
+        queue->pending_ = EVALUATE(take,mpsc_queue(type))(queue);                           \
+        if (!queue->pending_) return false;                                                 \
+    }                                                                                       \
+                                                                                            \
+    node = queue->pending_;                                                                 \
+    queue->pending_ = node->next_;                                                          \
+    *value = node->data_;                                                                   \
+                                                                                            \
+    if (!queue->retired_)                                                                   \
+        queue->retired_last_ = node;                                                        \
+    node->next_ = queue->retired_;                                                          \
+    queue->retired_ = node;                                                                 \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+unsigned EVALUATE(take_all,mpsc_queue(type)) (mpsc_queue(type) * queue,                     \
+                 EVALUATE(call_back,type) cb)                                               \
+{                                                                                           \
+    m_node(type) * first;                                                                   \
+    m_node(type) * last;                                                                    \
+    unsigned count = 0;                                                                     \
+                                                                                            \
+    if (!queue) return 0;                                                                   \
+                                                                                            \
+    EVALUATE(flush,mpsc_queue(type))(queue);                                                \
+                                                                                            \
+    first = queue->pending_;                                                                \
+    queue->pending_ = NULL;                                                                 \
+                                                                                            \
+    if (first)                                                                              \
+    {                                                                                       \
+        for (last = first; last->next_; last = last->next_);                                \
+        last->next_ = EVALUATE(take,mpsc_queue(type))(queue);                               \
+    }                                                                                       \
+    else                                                                                    \
+    {                                                                                       \
+        first = EVALUATE(take,mpsc_queue(type))(queue);                                     \
+    }                                                                                       \
+                                                                                            \
+    if (!first) return 0;                                                                   \
+                                                                                            \
+    for (last = first; ; last = last->next_)                                                \
+    {                                                                                       \
+        if (cb) cb(&last->data_);                                                           \
+        ++count;                                                                            \
+        if (!last->next_) break;                                                            \
+    }                                                                                       \
+                                                                                            \
+    EVALUATE(recycle,mpsc_queue(type))(queue, first, last);                                 \
+                                                                                            \
+    return count;                                                                           \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(empty,mpsc_queue(type)) (mpsc_queue(type) * queue)                            \
+{                                                                                           \
+    if (!queue) return true;                                                                \
+                                                                                            \
+    return !queue->pending_ && !atomic_load_explicit(&queue->head_, memory_order_acquire);  \
+}                                                                                           \
+
+/* Uniform function call syntax for all queues */
+#define create_mpsc_queue(type, _queue, _reserve) EVALUATE(create,mpsc_queue(type)) (&_queue, _reserve)
+/* frees every node of the queue (no producers may be running) */
+#define clear_mpsc_queue(type, _queue) EVALUATE(clear,mpsc_queue(type)) (&_queue)
+/* makes a producer handle for one thread */
+#define create_mpsc_producer(type, _queue) EVALUATE(create,mpsc_producer(type)) (&_queue)
+/* gives a producer's cached nodes back to the queue */
+#define release_mpsc_producer(type, _producer) EVALUATE(release,mpsc_producer(type)) (&_producer)
+/* pushes to the back of the queue (any thread, through its producer) */
+#define push_mpsc_queue(type, _producer, _value) EVALUATE(push,mpsc_queue(type)) (&_producer, _value)
+/* pops the front of the queue into _value (consumer only, bool) */
+#define pop_mpsc_queue(type, _queue, _value) EVALUATE(pop,mpsc_queue(type)) (&_queue, &_value)
+/* runs _func on everything queued so far (consumer only, unsigned) */
+#define take_all_mpsc_queue(type, _queue, _func) EVALUATE(take_all,mpsc_queue(type)) (&_queue, _func)
+/* returns whether or not the queue is empty (consumer only) */
+#define empty_mpsc_queue(type, _queue) EVALUATE(empty,mpsc_queue(type)) (&_queue)
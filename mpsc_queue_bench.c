@@ -0,0 +1,243 @@
+/******************************************************************************/
+/*
+* @file   mpsc_queue_bench.c
+* @author Aditya Harsh
+* @brief  Throughput of mpsc_queue against list behind a mutex, at 1 to
+*         max_producers producers (doubling). Each producer pushes its own
+*         numbered messages; the consumer checks they arrive in order.
+*
+*         cc -std=c11 -O2 -pthread mpsc_queue_bench.c -o mpsc_queue_bench
+*         ./mpsc_queue_bench [max_producers] [messages_per_producer]
+*/
+/******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+
+#include "mpsc_queue.h" /* mpsc_queue             */
+#include "list.h"       /* list                   */
+#include <stdio.h>      /* printf                 */
+#include <stdlib.h>     /* strtol                 */
+#include <pthread.h>    /* pthread_create, ...    */
+#include <time.h>       /* clock_gettime          */
+
+init_mpsc_queue(long)
+init_list(long)
+
+/* most producers run at once */
+#define MAX_PRODUCERS 64
+
+static mpsc_queue(long) queue;
+static list(long) locked_list;
+static pthread_mutex_t list_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* messages each producer pushes */
+static long messages = 2000000;
+/* consumer side bookkeeping (only the consumer touches these) */
+static long expected[MAX_PRODUCERS];
+static long received;
+static bool out_of_order;
+
+/**
+ * @brief Returns a monotonic time in seconds.
+ *
+ */
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Checks a message is the next one from its producer.
+ *
+ * @param message (producer * messages + sequence number)
+ */
+static void receive(long* message)
+{
+    long producer = *message / messages, sequence = *message % messages;
+
+    if (expected[producer] != sequence) out_of_order = true;
+
+    expected[producer] = sequence + 1;
+    ++received;
+}
+
+/**
+ * @brief Pushes every message through a producer of its own.
+ *
+ * @param arg (the producer number)
+ */
+static void* queue_producer(void* arg)
+{
+    long id = (long)arg, i;
+    mpsc_producer(long) producer = create_mpsc_producer(long, queue);
+
+    for (i = 0; i < messages; ++i)
+        while (!push_mpsc_queue(long, producer, id * messages + i));
+
+    release_mpsc_producer(long, producer);
+
+    return NULL;
+}
+
+/**
+ * @brief Pushes every message onto the list, taking the lock each time.
+ *
+ * @param arg (the producer number)
+ */
+static void* list_producer(void* arg)
+{
+    long id = (long)arg, i;
+
+    for (i = 0; i < messages; ++i)
+    {
+        pthread_mutex_lock(&list_lock);
+        push_back_list(long, locked_list, id * messages + i);
+        pthread_mutex_unlock(&list_lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Starts producers threads running func.
+ *
+ * @param threads
+ * @param producers
+ * @param func
+ */
+static void start(pthread_t* threads, int producers, void* (*func)(void*))
+{
+    int i;
+
+    for (i = 0; i < MAX_PRODUCERS; ++i)
+        expected[i] = 0;
+
+    received = 0;
+    out_of_order = false;
+
+    for (i = 0; i < producers; ++i)
+        pthread_create(&threads[i], NULL, func, (void*)(long)i);
+}
+
+/**
+ * @brief Waits for producers threads.
+ *
+ * @param threads
+ * @param producers
+ */
+static void finish(pthread_t* threads, int producers)
+{
+    int i;
+
+    for (i = 0; i < producers; ++i)
+        pthread_join(threads[i], NULL);
+}
+
+/**
+ * @brief Times the queue with some number of producers, popping singly and
+ *        taking all in turn.
+ *
+ * @param producers
+ * @return double (messages per second)
+ */
+static double bench_queue(int producers)
+{
+    pthread_t threads[MAX_PRODUCERS];
+    double time;
+    long message;
+
+    create_mpsc_queue(long, queue, 4096);
+
+    time = now();
+    start(threads, producers, queue_producer);
+
+    while (received < producers * messages)
+    {
+        if (received & 1)
+        {
+            if (pop_mpsc_queue(long, queue, message)) receive(&message);
+        }
+        else
+        {
+            take_all_mpsc_queue(long, queue, receive);
+        }
+    }
+
+    finish(threads, producers);
+    time = now() - time;
+
+    clear_mpsc_queue(long, queue);
+
+    return (double)(producers * messages) / time;
+}
+
+/**
+ * @brief Times the list behind a mutex with some number of producers.
+ *
+ * @param producers
+ * @return double (messages per second)
+ */
+static double bench_list(int producers)
+{
+    pthread_t threads[MAX_PRODUCERS];
+    double time;
+    long message;
+
+    locked_list = create_list(long);
+
+    time = now();
+    start(threads, producers, list_producer);
+
+    while (received < producers * messages)
+    {
+        pthread_mutex_lock(&list_lock);
+
+        if (size_list(long, locked_list))
+        {
+            message = front_list(long, locked_list);
+            pop_front_list(long, locked_list);
+            receive(&message);
+        }
+
+        pthread_mutex_unlock(&list_lock);
+    }
+
+    finish(threads, producers);
+    time = now() - time;
+
+    clear_list(long, locked_list);
+
+    return (double)(producers * messages) / time;
+}
+
+int main(int argc, char** argv)
+{
+    int max_producers = argc > 1 ? (int)strtol(argv[1], NULL, 10) : 8;
+    int producers;
+    double rate;
+
+    if (argc > 2) messages = strtol(argv[2], NULL, 10);
+
+    if (max_producers < 1 || max_producers > MAX_PRODUCERS || messages < 1)
+    {
+        printf("usage: %s [max_producers (1 to %d)] [messages_per_producer]\n", argv[0], MAX_PRODUCERS);
+        return 1;
+    }
+
+    printf("producers  mpsc_queue      list + mutex\n");
+
+    for (producers = 1; producers <= max_producers; producers *= 2)
+    {
+        rate = bench_queue(producers);
+        printf("%-9d  %6.1f Mmsg/s%s", producers, rate / 1e6, out_of_order ? " (OUT OF ORDER)" : "");
+
+        rate = bench_list(producers);
+        printf("  %6.1f Mmsg/s%s\n", rate / 1e6, out_of_order ? " (OUT OF ORDER)" : "");
+    }
+
+    return 0;
+}
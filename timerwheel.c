@@ -0,0 +1,451 @@
+/******************************************************************************/
+/*
+* @file   timerwheel.c
+* @author Aditya Harsh
+* @brief  Hierarchical timer wheel. Schedules and cancels in O(1).
+*/
+/******************************************************************************/
+
+#include "timerwheel.h" /* timer wheel interface */
+#include "list.h"       /* init_compact_list     */
+#include <stdlib.h>     /* malloc, realloc, free */
+
+/* number of levels, and slots per level */
+#define TW_LEVELS 4
+#define TW_BITS 6
+#define TW_SLOTS (1 << TW_BITS)
+#define TW_MASK (TW_SLOTS - 1)
+/* furthest a timer can be placed from the current tick */
+#define TW_RANGE (1UL << (TW_LEVELS * TW_BITS))
+/* batch size handed out the first time timers expire */
+#define TW_BATCH_CAPACITY 64
+
+/* record states */
+#define TIMER_FREE 0
+#define TIMER_ACTIVE 1
+#define TIMER_CANCELLED 2
+
+/* slots hold indices into the record array */
+typedef unsigned tw_index;
+init_compact_list(tw_index)
+
+/**
+ * @brief A scheduled timer.
+ *
+ */
+typedef struct
+{
+    /* tick the timer fires on */
+    unsigned long expires_;
+    /* passed to the expiry callback */
+    void* data_;
+
+    /* bumped every time the record is reused */
+    unsigned generation_;
+    /* next record on the free list */
+    tw_index next_free_;
+    unsigned char state_;
+} timer_record;
+
+/**
+ * @brief Timer wheel struct.
+ *
+ */
+struct timer_wheel
+{
+    /* the current tick */
+    unsigned long now_;
+
+    /* level 0 holds one tick per slot, every level above 64 times more */
+    list(tw_index) slots_[TW_LEVELS][TW_SLOTS];
+    /* empty slot swapped in while a slot is being expired */
+    list(tw_index) spare_;
+
+    /* timer records, reused through a free list */
+    timer_record* records_;
+    unsigned capacity_;
+    unsigned used_;
+    tw_index free_;
+    /* records still sitting in a slot (pending or cancelled) */
+    unsigned in_use_;
+    /* timers that will still fire */
+    unsigned pending_;
+
+    /* data of the timers expiring on the current tick */
+    void** batch_;
+    unsigned batch_capacity_;
+    TIMERFUNC func_;
+};
+
+/**
+ * @brief Takes a record off the free list, or grows the record array.
+ *
+ * @param wheel
+ * @return tw_index (LIST_NIL on failure)
+ */
+static tw_index alloc_record(timer_wheel* wheel)
+{
+    timer_record* records;
+    unsigned capacity;
+    tw_index index;
+
+    if (wheel->free_ != LIST_NIL)
+    {
+        index = wheel->free_;
+        wheel->free_ = wheel->records_[index].next_free_;
+    }
+    else
+    {
+        if (wheel->used_ == wheel->capacity_)
+        {
+            capacity = wheel->capacity_ ? wheel->capacity_ * 2 : TW_SLOTS;
+            records = realloc(wheel->records_, sizeof(timer_record) * capacity);
+            if (!records) return LIST_NIL;
+            wheel->records_ = records;
+            wheel->capacity_ = capacity;
+        }
+
+        index = wheel->used_++;
+        wheel->records_[index].generation_ = 1;
+    }
+
+    ++wheel->in_use_;
+
+    return index;
+}
+
+/**
+ * @brief Puts a record back on the free list, invalidating its handles.
+ *
+ * @param wheel
+ * @param index
+ */
+static void release_record(timer_wheel* wheel, tw_index index)
+{
+    timer_record* record = wheel->records_ + index;
+
+    record->state_ = TIMER_FREE;
+    if (!++record->generation_)
+        record->generation_ = 1;
+    record->next_free_ = wheel->free_;
+    wheel->free_ = index;
+
+    --wheel->in_use_;
+}
+
+/**
+ * @brief Places a record in the slot matching its expiry.
+ *
+ * @param wheel
+ * @param index
+ * @return true
+ * @return false
+ */
+static bool add_timer(timer_wheel* wheel, tw_index index)
+{
+    list(tw_index)* slot;
+    unsigned long base = wheel->now_ + 1;
+    unsigned long expires = wheel->records_[index].expires_;
+    unsigned long delta = expires - base;
+    unsigned level, size;
+
+    /* too far out, park it in the last slot and place it again on cascade */
+    if (delta >= TW_RANGE)
+    {
+        expires = base + TW_RANGE - 1;
+        delta = TW_RANGE - 1;
+    }
+
+    for (level = 0; delta >> (TW_BITS * (level + 1)); ++level);
+
+    slot = &wheel->slots_[level][(expires >> (TW_BITS * level)) & TW_MASK];
+    size = size_list(tw_index, *slot);
+
+    push_back_list(tw_index, *slot, index);
+
+    return size_list(tw_index, *slot) != size;
+}
+
+/**
+ * @brief Moves every timer in a slot down to the levels below it.
+ *
+ * @param wheel
+ * @param level
+ * @param slot
+ */
+static void cascade(timer_wheel* wheel, unsigned level, unsigned slot)
+{
+    list(tw_index)* bucket = &wheel->slots_[level][slot];
+    tw_index index;
+
+    while (size_list(tw_index, *bucket))
+    {
+        index = front_list(tw_index, *bucket);
+        pop_front_list(tw_index, *bucket);
+
+        if (wheel->records_[index].state_ == TIMER_CANCELLED)
+        {
+            release_record(wheel, index);
+        }
+        else if (!add_timer(wheel, index))
+        {
+            /* out of memory, the timer is lost */
+            --wheel->pending_;
+            release_record(wheel, index);
+        }
+    }
+}
+
+/**
+ * @brief Advances the clock by one tick and expires its slot.
+ *
+ * @param wheel
+ */
+static void run_tick(timer_wheel* wheel)
+{
+    list(tw_index) bucket;
+    unsigned long base = wheel->now_ + 1;
+    unsigned level, count = 0;
+    unsigned capacity;
+    void** batch;
+    void* data;
+    tw_index index;
+
+    /* refill the level below every time it wraps around */
+    for (level = 1; level < TW_LEVELS; ++level)
+    {
+        if ((base >> (TW_BITS * (level - 1))) & TW_MASK) break;
+        cascade(wheel, level, (base >> (TW_BITS * level)) & TW_MASK);
+    }
+
+    wheel->now_ = base;
+
+    /* callbacks may schedule into this slot again, so expire a detached copy */
+    bucket = wheel->slots_[0][base & TW_MASK];
+    wheel->slots_[0][base & TW_MASK] = wheel->spare_;
+
+    while (size_list(tw_index, bucket))
+    {
+        index = front_list(tw_index, bucket);
+        pop_front_list(tw_index, bucket);
+
+        if (wheel->records_[index].state_ == TIMER_ACTIVE)
+        {
+            data = wheel->records_[index].data_;
+            --wheel->pending_;
+            release_record(wheel, index);
+
+            if (count == wheel->batch_capacity_)
+            {
+                capacity = wheel->batch_capacity_ ? wheel->batch_capacity_ * 2
+                                                  : TW_BATCH_CAPACITY;
+                batch = realloc(wheel->batch_, sizeof(void*) * capacity);
+
+                if (batch)
+                {
+                    wheel->batch_ = batch;
+                    wheel->batch_capacity_ = capacity;
+                }
+                else
+                {
+                    /* can't grow the batch, hand out what we have so far */
+                    if (count && wheel->func_)
+                        wheel->func_(wheel->batch_, count);
+                    count = 0;
+
+                    if (!wheel->batch_capacity_)
+                    {
+                        if (wheel->func_)
+                            wheel->func_(&data, 1);
+                        continue;
+                    }
+                }
+            }
+
+            wheel->batch_[count++] = data;
+        }
+        else
+        {
+            release_record(wheel, index);
+        }
+    }
+
+    wheel->spare_ = bucket;
+
+    if (count && wheel->func_)
+        wheel->func_(wheel->batch_, count);
+}
+
+/**
+ * @brief Allocates a timer wheel.
+ *
+ * @param func
+ * @return timer_wheel*
+ */
+timer_wheel* alloc_timer_wheel(TIMERFUNC func)
+{
+    /* iterators */
+    unsigned level, slot;
+
+    /* allocate the data */
+    timer_wheel* wheel = malloc(sizeof(timer_wheel));
+
+    /* check if allocation succeeded */
+    if (wheel)
+    {
+        for (level = 0; level < TW_LEVELS; ++level)
+            for (slot = 0; slot < TW_SLOTS; ++slot)
+                wheel->slots_[level][slot] = create_list(tw_index);
+        wheel->spare_ = create_list(tw_index);
+
+        /* set values */
+        wheel->now_ = 0;
+        wheel->records_ = NULL;
+        wheel->capacity_ = 0;
+        wheel->used_ = 0;
+        wheel->free_ = LIST_NIL;
+        wheel->in_use_ = 0;
+        wheel->pending_ = 0;
+        wheel->batch_ = NULL;
+        wheel->batch_capacity_ = 0;
+        wheel->func_ = func;
+    }
+
+    return wheel;
+}
+
+/**
+ * @brief Frees allocated memory.
+ *
+ * @param wheel
+ */
+void free_timer_wheel(timer_wheel** wheel)
+{
+    /* iterators */
+    unsigned level, slot;
+
+    if (wheel && *wheel)
+    {
+        for (level = 0; level < TW_LEVELS; ++level)
+            for (slot = 0; slot < TW_SLOTS; ++slot)
+                clear_list(tw_index, (*wheel)->slots_[level][slot]);
+        clear_list(tw_index, (*wheel)->spare_);
+
+        free((*wheel)->records_);
+        free((*wheel)->batch_);
+        free(*wheel);
+        *wheel = NULL;
+    }
+}
+
+/**
+ * @brief Schedules a timer.
+ *
+ * @param wheel
+ * @param delay
+ * @param data
+ * @return timer_handle
+ */
+timer_handle schedule_timer(timer_wheel* wheel, unsigned long delay, void* data)
+{
+    timer_handle handle = {0, 0};
+    tw_index index;
+
+    if (!wheel) return handle;
+
+    index = alloc_record(wheel);
+    if (index == LIST_NIL) return handle;
+
+    wheel->records_[index].expires_ = wheel->now_ + (delay ? delay : 1);
+    wheel->records_[index].data_ = data;
+    wheel->records_[index].state_ = TIMER_ACTIVE;
+
+    if (!add_timer(wheel, index))
+    {
+        release_record(wheel, index);
+        return handle;
+    }
+
+    ++wheel->pending_;
+
+    handle.index_ = index;
+    handle.generation_ = wheel->records_[index].generation_;
+
+    return handle;
+}
+
+/**
+ * @brief Cancels a timer. The record stays in its slot until the wheel
+ *        reaches it, so this never has to search a slot.
+ *
+ * @param wheel
+ * @param handle
+ * @return true
+ * @return false
+ */
+bool cancel_timer(timer_wheel* wheel, timer_handle handle)
+{
+    timer_record* record;
+
+    if (!wheel || handle.index_ >= wheel->used_) return false;
+
+    record = wheel->records_ + handle.index_;
+
+    if (record->generation_ != handle.generation_ || record->state_ != TIMER_ACTIVE)
+        return false;
+
+    record->state_ = TIMER_CANCELLED;
+    --wheel->pending_;
+
+    return true;
+}
+
+/**
+ * @brief Moves the clock forward. Every tick that has timers expiring calls
+ *        the callback once with all of them.
+ *
+ * @param wheel
+ * @param ticks
+ */
+void advance_timer_wheel(timer_wheel* wheel, unsigned long ticks)
+{
+    if (!wheel) return;
+
+    while (ticks--)
+    {
+        /* every slot is empty, skip the rest */
+        if (!wheel->in_use_)
+        {
+            wheel->now_ += ticks + 1;
+            break;
+        }
+
+        run_tick(wheel);
+    }
+}
+
+/**
+ * @brief Returns the current tick.
+ *
+ * @param wheel
+ * @return unsigned long
+ */
+unsigned long timer_wheel_now(const timer_wheel* wheel)
+{
+    if (!wheel) return 0;
+
+    return wheel->now_;
+}
+
+/**
+ * @brief Returns the number of timers that will still fire.
+ *
+ * @param wheel
+ * @return unsigned
+ */
+unsigned pending_timers(const timer_wheel* wheel)
+{
+    if (!wheel) return 0;
+
+    return wheel->pending_;
+}
@@ -0,0 +1,36 @@
+/******************************************************************************/
+/*
+* @file   timerwheel.h
+* @author Aditya Harsh
+* @brief  Hierarchical timer wheel. Schedules and cancels in O(1).
+*/
+/******************************************************************************/
+
+#pragma once
+
+/* define boolean values */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+/* opaque struct pointer */
+typedef struct timer_wheel timer_wheel;
+/* identifies a scheduled timer (generation 0 is never valid) */
+typedef struct { unsigned index_; unsigned generation_; } timer_handle;
+/* receives the data of every timer that expired on the same tick */
+typedef void (*TIMERFUNC)(void** data, unsigned count);
+
+/* allocates a timer wheel, starting at tick 0 */
+timer_wheel* alloc_timer_wheel(TIMERFUNC func);
+/* frees a timer wheel (pending timers never fire) */
+void free_timer_wheel(timer_wheel** wheel);
+/* schedules data to expire after a number of ticks (0 = on the next tick) */
+timer_handle schedule_timer(timer_wheel* wheel, unsigned long delay, void* data);
+/* cancels a pending timer, returns whether or not it was still pending */
+bool cancel_timer(timer_wheel* wheel, timer_handle handle);
+/* moves the clock forward, running the expiry callback once per tick */
+void advance_timer_wheel(timer_wheel* wheel, unsigned long ticks);
+/* returns the current tick */
+unsigned long timer_wheel_now(const timer_wheel* wheel);
+/* returns the number of pending timers */
+unsigned pending_timers(const timer_wheel* wheel);
@@ -0,0 +1,307 @@
+/******************************************************************************/
+/*
+* @file   tvector.h
+* @author Aditya Harsh
+* @brief  Type-specialized vector. Written in ANSI-C.
+*/
+/******************************************************************************/
+
+/* HOW TO USE
+- Place init_vector(some type) on top your file
+- Use the uniform functions to on the bottom of the file
+- Unlike vector.h, elements are stored and returned by value, so the compiler
+  sees the real element type and can inline and vectorize loops over
+  data_vec(). The macros end in _vec so this header can sit next to vector.h.
+
+    EXAMPLE:
+        #include "tvector.h"
+
+        init_vector(int)
+
+        int main(void)
+        {
+            vector(int) my_vector = create_vec(int);
+
+            push_back_vec(int, my_vector, 1);
+            push_back_vec(int, my_vector, 2);
+            push_front_vec(int, my_vector, 100);
+
+            clear_vec(int, my_vector);
+
+            return 0;
+        }
+ */
+
+#pragma once
+
+#include <stdlib.h> /* realloc, free, NULL */
+#include <string.h> /* memset, memcpy, memmove */
+#include <limits.h> /* UINT_MAX */
+
+/* macro helper functions */
+#define PASTE(x, y) x ## _ ## y
+#define EVALUATE(x, y) PASTE(x, y)
+
+/* define vector */
+#define vector(type) EVALUATE(vector,type)
+
+/* define booleans */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
+typedef enum {false = 0, true = 1} bool;
+#endif
+
+/* capacity of the first allocation */
+#define VECTOR_MIN_CAPACITY 8
+
+/* call to setup the type */
+#define init_vector(type)                                                                   \
+                                                                                            \
+typedef void (*EVALUATE(call_back,vector(type))) (type*);                                   \
+                                                                                            \
+typedef struct                                                                              \
+{                                                                                           \
+    type * data_;                                                                           \
+    unsigned size_;                                                                         \
+    unsigned capacity_;                                                                     \
+} vector(type);                                                                             \
+                                                                                            \
+vector(type) EVALUATE(create,vector(type)) (void)                                           \
+{                                                                                           \
+    vector(type) vec = {NULL, 0, 0};                                                        \
+    return vec;                                                                             \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(clear,vector(type)) (vector(type) * vec)                                      \
+{                                                                                           \
+    if (!vec) return;                                                                       \
+                                                                                            \
+    free(vec->data_);                                                                       \
+                                                                                            \
+    vec->data_ = NULL;                                                                      \
+    vec->size_ = 0;                                                                         \
+    vec->capacity_ = 0;                                                                     \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(reserve,vector(type)) (vector(type) * vec, unsigned capacity)                 \
+{                                                                                           \
+    type * data;                                                                            \
+                                                                                            \
+    if (!vec) return false;                                                                 \
+    if (capacity <= vec->capacity_) return true;                                            \
+    /* the bytes wouldn't fit in a size_t */                                                \
+    if (sizeof(type) > (size_t)-1 / capacity) return false;                                 \
+                                                                                            \
+    data = realloc(vec->data_, sizeof(type) * capacity);                                    \
+    if (!data) return false;                                                                \
+                                                                                            \
+    vec->data_ = data;                                                                      \
+    vec->capacity_ = capacity;                                                              \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(grow,vector(type)) (vector(type) * vec)                                       \
+{                                                                                           \
+    /* doubling stops at UINT_MAX, past that there's no bigger capacity */                  \
+    if (vec->capacity_ == UINT_MAX) return false;                                           \
+                                                                                            \
+    return EVALUATE(reserve,vector(type))(vec, !vec->capacity_ ? VECTOR_MIN_CAPACITY :      \
+           vec->capacity_ > UINT_MAX / 2 ? UINT_MAX : vec->capacity_ * 2);                  \
+}                                                                                           \
+                                                                                            \
+bool EVALUATE(resize,vector(type)) (vector(type) * vec, unsigned size)                      \
+{                                                                                           \
+    if (!vec) return false;                                                                 \
+                                                                                            \
+    if (size > vec->capacity_ && !EVALUATE(reserve,vector(type))(vec, size))                \
+        return false;                                                                       \
+                                                                                            \
+    if (size > vec->size_)                                                                  \
+        memset(vec->data_ + vec->size_, 0, sizeof(type) * (size - vec->size_));             \
+                                                                                            \
+    vec->size_ = size;                                                                      \
+                                                                                            \
+    return true;                                                                            \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(shrink_to_fit,vector(type)) (vector(type) * vec)                              \
+{                                                                                           \
+    type * data;                                                                            \
+                                                                                            \
+    if (!vec || vec->size_ == vec->capacity_) return;                                       \
+                                                                                            \
+    if (!vec->size_)                                                                        \
+    {                                                                                       \
+        EVALUATE(clear,vector(type))(vec);                                                  \
+        return;                                                                             \
+    }                                                                                       \
+                                                                                            \
+    data = realloc(vec->data_, sizeof(type) * vec->size_);                                  \
+    if (!data) return;                                                                      \
+                                                                                            \
+    vec->data_ = data;                                                                      \
+    vec->capacity_ = vec->size_;                                                            \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(push_back,vector(type)) (vector(type) * vec, type value)                      \
+{                                                                                           \
+    if (!vec) return;                                                                       \
+                                                                                            \
+    if (vec->size_ == vec->capacity_ && !EVALUATE(grow,vector(type))(vec)) return;          \
+                                                                                            \
+    vec->data_[vec->size_++] = value;                                                       \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(push_front,vector(type)) (vector(type) * vec, type value)                     \
+{                                                                                           \
+    if (!vec) return;                                                                       \
+                                                                                            \
+    if (vec->size_ == vec->capacity_ && !EVALUATE(grow,vector(type))(vec)) return;          \
+                                                                                            \
+    memmove(vec->data_ + 1, vec->data_, sizeof(type) * vec->size_);                         \
+    vec->data_[0] = value;                                                                  \
+    ++vec->size_;                                                                           \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(remove,vector(type)) (vector(type) * vec, unsigned index)                     \
+{                                                                                           \
+    if (!vec || index >= vec->size_) return;                                                \
+                                                                                            \
+    memmove(vec->data_ + index, vec->data_ + index + 1,                                     \
+            sizeof(type) * (vec->size_ - index - 1));                                       \
+    --vec->size_;                                                                           \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(pop_back,vector(type)) (vector(type) * vec)                                   \
+{                                                                                           \
+    if (!vec || !vec->size_) return;                                                        \
+                                                                                            \
+    --vec->size_;                                                                           \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(pop_front,vector(type)) (vector(type) * vec)                                  \
+{                                                                                           \
+    EVALUATE(remove,vector(type))(vec, 0);                                                  \
+}                                                                                           \
+                                                                                            \
+type EVALUATE(get,vector(type)) (const vector(type) * vec, unsigned index)                  \
+{                                                                                           \
+    type garbage;                                                                           \
+                                                                                            \
+    if (!vec || index >= vec->size_)                                                        \
+    {                                                                                       \
+        memset(&garbage, 0, sizeof(type));                                                  \
+        return garbage;                                                                     \
+    }                                                                                       \
+                                                                                            \
+    return vec->data_[index];                                                               \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(set,vector(type)) (vector(type) * vec, unsigned index, type value)            \
+{                                                                                           \
+    if (!vec || index >= vec->size_) return;                                                \
+                                                                                            \
+    vec->data_[index] = value;                                                              \
+}                                                                                           \
+                                                                                            \
+type * EVALUATE(at,vector(type)) (const vector(type) * vec, unsigned index)                 \
+{                                                                                           \
+    if (!vec || index >= vec->size_) return NULL;                                           \
+                                                                                            \
+    return vec->data_ + index;                                                              \
+}                                                                                           \
+                                                                                            \
+type EVALUATE(front,vector(type)) (const vector(type) * vec)                                \
+{                                                                                           \
+    return EVALUATE(get,vector(type))(vec, 0);                                              \
+}                                                                                           \
+                                                                                            \
+type EVALUATE(back,vector(type)) (const vector(type) * vec)                                 \
+{                                                                                           \
+    return EVALUATE(get,vector(type))(vec, vec ? vec->size_ - 1 : 0);                       \
+}                                                                                           \
+                                                                                            \
+unsigned EVALUATE(size,vector(type)) (const vector(type) * vec)                             \
+{                                                                                           \
+    if (!vec) return 0;                                                                     \
+                                                                                            \
+    return vec->size_;                                                                      \
+}                                                                                           \
+                                                                                            \
+unsigned EVALUATE(capacity,vector(type)) (const vector(type) * vec)                         \
+{                                                                                           \
+    if (!vec) return 0;                                                                     \
+                                                                                            \
+    return vec->capacity_;                                                                  \
+}                                                                                           \
+                                                                                            \
+type * EVALUATE(data,vector(type)) (const vector(type) * vec)                               \
+{                                                                                           \
+    if (!vec) return NULL;                                                                  \
+                                                                                            \
+    return vec->data_;                                                                      \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(copy,vector(type)) (vector(type) * dest, const vector(type) * source)         \
+{                                                                                           \
+    if (!dest || !source || dest == source) return;                                         \
+                                                                                            \
+    if (!EVALUATE(reserve,vector(type))(dest, source->size_)) return;                       \
+                                                                                            \
+    if (source->size_)                                                                      \
+        memcpy(dest->data_, source->data_, sizeof(type) * source->size_);                   \
+    dest->size_ = source->size_;                                                            \
+}                                                                                           \
+                                                                                            \
+void EVALUATE(foreach,vector(type)) (vector(type) * vec,                                    \
+             EVALUATE(call_back,vector(type)) cb)                                           \
+{                                                                                           \
+    unsigned i;                                                                             \
+                                                                                            \
+    if (!vec) return;                                                                       \
+                                                                                            \
+    for (i = 0; i < vec->size_; ++i)                                                        \
+        cb(vec->data_ + i);                                                                 \
+}                                                                                           \
+
+/* Uniform function call syntax for all vectors */
+#define create_vec(type) EVALUATE(create,vector(type)) ()
+/* clears the vector and frees its memory */
+#define clear_vec(type, _vec) EVALUATE(clear,vector(type)) (&_vec)
+/* makes room for at least _capacity elements (bool) */
+#define reserve_vec(type, _vec, _capacity) EVALUATE(reserve,vector(type)) (&_vec, _capacity)
+/* sets the size, new elements are zeroed (bool) */
+#define resize_vec(type, _vec, _size) EVALUATE(resize,vector(type)) (&_vec, _size)
+/* matches the capacity of a vector to its size */
+#define shrink_to_fit_vec(type, _vec) EVALUATE(shrink_to_fit,vector(type)) (&_vec)
+/* pushes to the back of the vector */
+#define push_back_vec(type, _vec, _value) EVALUATE(push_back,vector(type)) (&_vec, _value)
+/* pushes to the front of the vector */
+#define push_front_vec(type, _vec, _value) EVALUATE(push_front,vector(type)) (&_vec, _value)
+/* removes the element at an index */
+#define remove_vec(type, _vec, _index) EVALUATE(remove,vector(type)) (&_vec, _index)
+/* pops the back of the vector */
+#define pop_back_vec(type, _vec) EVALUATE(pop_back,vector(type)) (&_vec)
+/* pops the first element in the vector */
+#define pop_front_vec(type, _vec) EVALUATE(pop_front,vector(type)) (&_vec)
+/* gets an element in an index */
+#define get_vec(type, _vec, _index) EVALUATE(get,vector(type)) (&_vec, _index)
+/* sets an element in an index */
+#define set_vec(type, _vec, _index, _value) EVALUATE(set,vector(type)) (&_vec, _index, _value)
+/* gets a pointer to an element, NULL if out of range */
+#define at_vec(type, _vec, _index) EVALUATE(at,vector(type)) (&_vec, _index)
+/* gets the first element of a vector */
+#define front_vec(type, _vec) EVALUATE(front,vector(type)) (&_vec)
+/* gets the last element of a vector */
+#define back_vec(type, _vec) EVALUATE(back,vector(type)) (&_vec)
+/* gets the size of the vector (unsigned) */
+#define size_vec(type, _vec) EVALUATE(size,vector(type)) (&_vec)
+/* gets the capacity of the vector (unsigned) */
+#define capacity_vec(type, _vec) EVALUATE(capacity,vector(type)) (&_vec)
+/* gets the elements as a plain array */
+#define data_vec(type, _vec) EVALUATE(data,vector(type)) (&_vec)
+/* copies vectors */
+#define copy_vec(type, _destination, _source) EVALUATE(copy,vector(type)) (&_destination, &_source)
+/* runs a foreach on all elements within a vector */
+#define foreach_vec(type, _vec, _func) EVALUATE(foreach,vector(type)) (&_vec, _func)
@@ -7,12 +7,44 @@
 /******************************************************************************/
 
 #include "vector.h"   /* vector interface */
-#include <stdlib.h>   /* malloc, calloc, free */
+#include "vector_simd.h" /* find, count, min/max and sum kernels */
+#include "vector_sort.h" /* radix_sort */
+#include "vector_file.h" /* file_map, file_resize, file_unmap, file_write */
+#include <stdlib.h>   /* malloc, realloc, free, qsort */
 #include <stdio.h>    /* printf */
-#include <string.h>   /* memcpy, strcpy, strcmp */
+#include <string.h>   /* memcpy, memmove, memset, strcpy, strcmp */
+#include <stdint.h>   /* SIZE_MAX */
+#include <stdatomic.h> /* atomic_uint, atomic_* */
 
 /* default capacity is set to two */
 #define DEFAULT_CAPACITY 2
+/* capacity is doubled when full unless told otherwise */
+#define DEFAULT_GROWTH 2.0f
+
+/**
+ * @brief Registered element type. Interned, so types compare by pointer.
+ * 
+ */
+struct vector_type
+{
+    /* the name the type was registered under */
+    char* name_;
+    /* the size and alignment of one element */
+    unsigned size_;
+    unsigned alignment_;
+
+    /* element callbacks (NULL = plain bytes) */
+    PRINTFUNC print_;
+    COPYFUNC copy_;
+    DESTROYFUNC destroy_;
+
+    /* true if it came from register_type, false for alloc_vector's plain
+       types, which are keyed by name and size */
+    bool registered_;
+
+    /* the next type in the same registry bucket */
+    vector_type* next_;
+};
 
 /**
  * @brief Vector struct.
@@ -21,74 +53,341 @@
 struct vector
 {
     /* the number of elements */
-    unsigned size_;
+    size_t size_;
     /* the max number of elements */
-    unsigned capacity_;
-    /* the size of the data */
+    size_t capacity_;
+    /* the size of the data (cached from type_) */
     unsigned data_size_;
+    /* the capacity is multiplied by this when full */
+    float growth_;
 
     /* holds the type of data */
-    char* data_type_;
+    const vector_type* type_;
     PRINTFUNC pf_;
 
-    /* the array of data stored inside the vector */
-    void** data_;
+    /* where the memory comes from (both NULL = the heap) */
+    arena* arena_;
+    vector_file* file_;
+
+    /* the elements, stored back to back (capacity_ * data_size_ bytes) */
+    unsigned char* data_;
 };
 
-/* forward declare */
-static void copy_vector_shallow(vector** destination, const vector* source);
+/**
+ * @brief Heap elements are preceded by a reference count, shared by every
+ *        vector copied from them.
+ * 
+ */
+typedef struct
+{
+    /* the vectors using the elements */
+    atomic_uint refs_;
+} vector_storage;
+
+/* keeps the elements as aligned as malloc's memory */
+#define STORAGE_HEADER 16
+
+/* the reference count of heap elements */
+#define STORAGE(data) ((vector_storage*)((data) - STORAGE_HEADER))
+
+/* the most elements of a size one allocation holds (with the header, so
+   the byte count never wraps) */
+#define STORAGE_MAX(size) ((SIZE_MAX - STORAGE_HEADER) / (size))
+
+/**
+ * @brief Allocates heap elements with one reference.
+ * 
+ * @param count 
+ * @param size (of one element, not 0)
+ * @return unsigned char* (NULL on failure, or if the bytes don't fit in a
+ *         size_t)
+ */
+static unsigned char* alloc_storage(size_t count, size_t size)
+{
+    unsigned char* memory;
+
+    if (count > STORAGE_MAX(size)) return NULL;
+
+    memory = malloc(STORAGE_HEADER + count * size);
+    if (!memory) return NULL;
+
+    atomic_init(&((vector_storage*)memory)->refs_, 1);
+
+    return memory + STORAGE_HEADER;
+}
+
+/**
+ * @brief Frees heap elements.
+ * 
+ * @param data 
+ */
+static void free_storage(unsigned char* data)
+{
+    if (data) free(data - STORAGE_HEADER);
+}
+
+/* buckets in the type registry (a power of two) */
+#define REGISTRY_BUCKETS 256
+
+/* every type, hashed by name (and size, for plain types). Nodes are never
+   changed once they're in, so lookups need no lock and new ones go in
+   with a compare and swap on the bucket */
+static vector_type* _Atomic registry[REGISTRY_BUCKETS];
+
+/**
+ * @brief Picks the bucket for a type.
+ * 
+ * @param name 
+ * @param size (0 for registered types, they're found by name alone)
+ * @return size_t 
+ */
+static size_t type_bucket(const char* name, unsigned size)
+{
+    /* FNV-1a */
+    uint64_t hash = 14695981039346656037u;
+
+    for (; *name; ++name)
+        hash = (hash ^ (unsigned char)*name) * 1099511628211u;
+
+    hash = (hash ^ size) * 1099511628211u;
+
+    return (size_t)(hash ^ (hash >> 32)) & (REGISTRY_BUCKETS - 1);
+}
 
 /**
- * @brief Allocates a vector of any type of elements.
+ * @brief Looks through a bucket, from first up to (not including) last.
  * 
+ * @param first 
+ * @param last 
+ * @param name 
+ * @param size (only compared for plain types)
+ * @param registered 
+ * @return vector_type* (NULL if it isn't there)
+ */
+static vector_type* find_in(vector_type* first, const vector_type* last, const char* name,
+                            unsigned size, bool registered)
+{
+    for (; first != last; first = first->next_)
+        if (first->registered_ == registered && (registered || first->size_ == size) &&
+            !strcmp(first->name_, name))
+            return first;
+
+    return NULL;
+}
+
+/**
+ * @brief Adds a type to the registry, unless another thread added the same
+ *        one first (then that one is returned and type is freed).
+ * 
+ * @param type 
+ * @param head (the bucket head the caller searched from)
+ * @return vector_type* 
+ */
+static vector_type* intern_type(vector_type* type, vector_type* head)
+{
+    vector_type* _Atomic* bucket = registry + type_bucket(type->name_, type->registered_ ? 0 : type->size_);
+    vector_type* found;
+
+    while (true)
+    {
+        type->next_ = head;
+
+        if (atomic_compare_exchange_weak_explicit(bucket, &head, type, memory_order_release,
+                                                  memory_order_acquire))
+            return type;
+
+        /* only what went in since the last try needs checking */
+        found = find_in(head, type->next_, type->name_, type->size_, type->registered_);
+        if (found)
+        {
+            free(type->name_);
+            free(type);
+            return found;
+        }
+    }
+}
+
+/**
+ * @brief Makes a type that isn't in the registry yet.
+ * 
+ * @param name 
+ * @param size 
+ * @param alignment 
+ * @param print 
+ * @param copy 
+ * @param destroy 
+ * @param registered 
+ * @return vector_type* (NULL on failure)
+ */
+static vector_type* make_type(const char* name, unsigned size, unsigned alignment, PRINTFUNC print,
+                              COPYFUNC copy, DESTROYFUNC destroy, bool registered)
+{
+    vector_type* type = malloc(sizeof(vector_type));
+
+    if (!type) return NULL;
+
+    type->name_ = malloc(sizeof(char) * (strlen(name) + 1));
+    if (!type->name_)
+    {
+        free(type);
+        return NULL;
+    }
+
+    strcpy(type->name_, name);
+    type->size_ = size;
+    type->alignment_ = alignment;
+    type->print_ = print;
+    type->copy_ = copy;
+    type->destroy_ = destroy;
+    type->registered_ = registered;
+
+    return type;
+}
+
+/**
+ * @brief Returns the largest power of two (up to 16) dividing size.
+ * 
+ * @param size 
+ * @return unsigned 
+ */
+static unsigned default_alignment(unsigned size)
+{
+    unsigned alignment;
+
+    for (alignment = 1; alignment < 16 && size && !(size & alignment); alignment <<= 1);
+
+    return alignment;
+}
+
+/**
+ * @brief Finds a registered type. Safe to call from any thread.
+ * 
+ * @param name 
+ * @return const vector_type* (NULL if it isn't registered)
+ */
+const vector_type* find_type(const char* name)
+{
+    if (!name) return NULL;
+
+    return find_in(atomic_load_explicit(registry + type_bucket(name, 0), memory_order_acquire),
+                   NULL, name, 0, true);
+}
+
+/**
+ * @brief Registers a type, or returns the one already registered under the
+ *        name if it's the same. Safe to call from any thread.
+ * 
+ * @param name 
+ * @param size 
+ * @param alignment (0 = the largest power of two dividing size)
+ * @param print 
+ * @param copy 
+ * @param destroy 
+ * @return const vector_type* (NULL if the name is registered with a
+ *                             different size, alignment or callbacks)
+ */
+const vector_type* register_type(const char* name, unsigned size, unsigned alignment,
+                                 PRINTFUNC print, COPYFUNC copy, DESTROYFUNC destroy)
+{
+    vector_type* head;
+    vector_type* type;
+
+    if (!name) return NULL;
+
+    if (!alignment) alignment = default_alignment(size);
+
+    /* alignment has to be a power of two that divides the size */
+    if (alignment & (alignment - 1) || size % alignment) return NULL;
+
+    /* interned, so the same name always maps to the same type */
+    head = atomic_load_explicit(registry + type_bucket(name, 0), memory_order_acquire);
+    type = find_in(head, NULL, name, 0, true);
+
+    if (!type)
+    {
+        type = make_type(name, size, alignment, print, copy, destroy, true);
+        if (!type) return NULL;
+
+        type = intern_type(type, head);
+    }
+
+    /* a name means one thing, registering it again with anything else fails */
+    if (type->size_ != size || type->alignment_ != alignment || type->print_ != print ||
+        type->copy_ != copy || type->destroy_ != destroy)
+        return NULL;
+
+    return type;
+}
+
+/**
+ * @brief Returns the plain (no callbacks) type alloc_vector uses for a name
+ *        and size, adding it the first time. Kept apart from registered
+ *        types, so a name can be used at any size, as it always could.
+ * 
+ * @param name 
+ * @param size 
+ * @return const vector_type* (NULL on failure)
+ */
+static const vector_type* plain_type(const char* name, unsigned size)
+{
+    vector_type* head;
+    vector_type* type;
+
+    if (!name) return NULL;
+
+    head = atomic_load_explicit(registry + type_bucket(name, size), memory_order_acquire);
+    type = find_in(head, NULL, name, size, false);
+    if (type) return type;
+
+    type = make_type(name, size, default_alignment(size), NULL, NULL, NULL, false);
+    if (!type) return NULL;
+
+    return intern_type(type, head);
+}
+
+/**
+ * @brief Allocates a vector of a registered type, on the heap or in an arena.
+ * 
+ * @param a (NULL = the heap)
  * @param capacity
- * @param data_size
- * @param data_type
- * @param func
+ * @param type
+ * @param storage (false = no elements and no capacity yet, for a heap
+ *                vector that's about to share another's)
  */
-vector* alloc_vector(unsigned capacity, unsigned data_size, const char* data_type, PRINTFUNC func)
+static vector* create_vector(arena* a, size_t capacity, const vector_type* type, bool storage)
 {
     /* allocate the data */
-    vector* vec = malloc(sizeof(vector));
+    vector* vec;
+
+    /* the elements' bytes wouldn't fit in a size_t (heap or arena) */
+    if (!type || capacity > STORAGE_MAX(type->size_)) return NULL;
+
+    vec = a ? arena_alloc(a, sizeof(vector), 0) : malloc(sizeof(vector));
 
     /* check if allocation succeeded */
     if (vec)
     {
         /* allocate memory (0 = default capacity) */
-        if (capacity)
-        {
-            vec->data_ = calloc(capacity, sizeof(void*));
-            vec->capacity_ = capacity;
-        }
-        else
-        {
-            vec->data_ = calloc(DEFAULT_CAPACITY, sizeof(void*));
-            vec->capacity_ = DEFAULT_CAPACITY;
-        }
+        vec->capacity_ = !storage ? 0 : capacity ? capacity : DEFAULT_CAPACITY;
+        vec->data_ = !storage ? NULL
+                   : a ? arena_alloc(a, vec->capacity_ * type->size_, type->alignment_)
+                       : alloc_storage(vec->capacity_, type->size_);
 
         /* check for successful allocation */
-        if (!vec->data_)
+        if (storage && !vec->data_)
         {
-            free(vec);
-            return NULL;
-        }
-
-        /* store the name of the type */
-        vec->data_type_ = malloc(sizeof(char) * (strlen(data_type) + 1));
-
-        /* free allocated memory */
-        if (!vec->data_type_)
-        {
-            free(vec->data_);
-            free(vec);
+            if (!a) free(vec);
             return NULL;
         }
 
         /* set values */
-        strcpy(vec->data_type_, data_type);
         vec->size_ = 0;
-        vec->data_size_ = data_size;
-        vec->pf_ = func;
+        vec->data_size_ = type->size_;
+        vec->growth_ = DEFAULT_GROWTH;
+        vec->type_ = type;
+        vec->pf_ = type->print_;
+        vec->arena_ = a;
+        vec->file_ = NULL;
 
         return vec;
     }
@@ -98,44 +397,429 @@ vector* alloc_vector(unsigned capacity, unsigned data_size, const char* data_typ
 }
 
 /**
- * @brief Frees allocated memory.
+ * @brief Allocates a vector of a registered type.
+ * 
+ * @param capacity
+ * @param type
+ */
+vector* alloc_vector_of(size_t capacity, const vector_type* type)
+{
+    return create_vector(NULL, capacity, type, true);
+}
+
+/**
+ * @brief Allocates a vector of any type of elements, as plain bytes. The
+ *        type is looked up by data_type and data_size (added the first time
+ *        it's seen), without a lock.
+ * 
+ * @param capacity
+ * @param data_size
+ * @param data_type
+ * @param func
+ */
+vector* alloc_vector(size_t capacity, unsigned data_size, const char* data_type, PRINTFUNC func)
+{
+    return alloc_vector_in(NULL, capacity, data_size, data_type, func);
+}
+
+/**
+ * @brief Allocates a vector whose header and elements come from an arena.
+ *        Growing copies into a new arena allocation, unless the elements are
+ *        the newest one and can grow where they are. Nothing is given back
+ *        until the arena is reset.
+ * 
+ * @param a (NULL = the heap)
+ * @param capacity
+ * @param data_size
+ * @param data_type
+ * @param func
+ */
+vector* alloc_vector_in(arena* a, size_t capacity, unsigned data_size, const char* data_type,
+                        PRINTFUNC func)
+{
+    vector* vec = create_vector(a, capacity, plain_type(data_type, data_size), true);
+
+    /* the print function stays per vector */
+    if (vec)
+        vec->pf_ = func;
+
+    return vec;
+}
+
+/**
+ * @brief Maps a vector onto a file, creating the file if it doesn't exist.
+ *        The elements live in the file and it grows with the vector, so
+ *        reopening it costs the same however many elements it holds.
+ *        Only types without copy or destroy callbacks can be mapped.
+ * 
+ * @param path 
+ * @param data_size
+ * @param data_type (NULL = whatever the file holds)
+ * @param func
+ * @return vector* (NULL on failure, or if the file holds another type)
+ */
+vector* vector_map_file(const char* path, unsigned data_size, const char* data_type,
+                        PRINTFUNC func)
+{
+    char name[VECTOR_FILE_TYPE] = "";
+    const vector_type* type;
+    vector_file* file;
+    size_t size, capacity = DEFAULT_CAPACITY;
+
+    /* allocate the data */
+    vector* vec;
+
+    if (data_type)
+    {
+        if (strlen(data_type) >= VECTOR_FILE_TYPE) return NULL;
+        strcpy(name, data_type);
+    }
+
+    file = file_map(path, data_size, name, &size, &capacity);
+    if (!file) return NULL;
+
+    /* pointers a callback would follow don't survive in a file */
+    type = find_type(name);
+    type = type && (type->copy_ || type->destroy_) ? NULL : plain_type(name, data_size);
+    vec = type ? malloc(sizeof(vector)) : NULL;
+
+    /* check if allocation succeeded */
+    if (!vec)
+    {
+        file_unmap(&file, size);
+        return NULL;
+    }
+
+    /* set values */
+    vec->size_ = size;
+    vec->capacity_ = capacity;
+    vec->data_size_ = data_size;
+    vec->growth_ = DEFAULT_GROWTH;
+    vec->type_ = type;
+    vec->pf_ = func;
+    vec->arena_ = NULL;
+    vec->file_ = file;
+    vec->data_ = file_data(file);
+
+    return vec;
+}
+
+/**
+ * @brief Writes the elements to a file vector_map_file can open. Types
+ *        with copy or destroy callbacks can't be saved. Neither can a
+ *        mapped vector over its own file, rewriting it would cut the
+ *        mapping short underneath it.
+ * 
+ * @param vec 
+ * @param path (not the file vec is mapped from)
+ * @return true 
+ * @return false 
+ */
+bool vector_save(const vector* vec, const char* path)
+{
+    if (!vec || !path || vec->type_->copy_ || vec->type_->destroy_) return false;
+    if (vec->file_ && file_same(vec->file_, path)) return false;
+
+    return file_write(path, vec->data_size_, vec->type_->name_, vec->data_, vec->size_);
+}
+
+/**
+ * @brief Runs the destroy callback on a range of elements.
+ * 
+ * @param vec 
+ * @param first 
+ * @param last (one past the end)
+ */
+static void destroy_elements(vector* vec, size_t first, size_t last)
+{
+    if (!vec->type_->destroy_) return;
+
+    for (; first < last; ++first)
+        vec->type_->destroy_(vec->data_ + first * vec->data_size_);
+}
+
+/**
+ * @brief Copies elements into uninitialized slots, through the copy
+ *        callback when the type has one.
+ * 
+ * @param vec 
+ * @param destination 
+ * @param source 
+ * @param count 
+ */
+static void copy_elements(const vector* vec, unsigned char* destination, const unsigned char* source,
+                          size_t count)
+{
+    if (!vec->type_->copy_)
+    {
+        memcpy(destination, source, count * vec->data_size_);
+        return;
+    }
+
+    for (; count; --count, destination += vec->data_size_, source += vec->data_size_)
+        vec->type_->copy_(destination, source);
+}
+
+/**
+ * @brief Checks if the elements are on the heap (so they can be shared).
+ * 
+ * @param vec 
+ * @return true 
+ * @return false 
+ */
+static bool on_heap(const vector* vec)
+{
+    return !vec->arena_ && !vec->file_;
+}
+
+/**
+ * @brief Checks if other vectors are using the same elements.
+ * 
+ * @param vec 
+ * @return true 
+ * @return false 
+ */
+static bool shared(const vector* vec)
+{
+    return on_heap(vec) && vec->data_ &&
+           atomic_load_explicit(&STORAGE(vec->data_)->refs_, memory_order_acquire) > 1;
+}
+
+/**
+ * @brief Lets go of the elements. The last vector using them destroys and
+ *        frees them, a mapped vector closes its file. Leaves the vector empty
+ *        with no capacity.
+ * 
+ * @param vec 
+ */
+static void release_elements(vector* vec)
+{
+    if (vec->file_)
+    {
+        /* the elements stay in the file for next time */
+        file_unmap(&vec->file_, vec->size_);
+    }
+    else if (vec->arena_)
+    {
+        destroy_elements(vec, 0, vec->size_);
+    }
+    else if (vec->data_ &&
+             atomic_fetch_sub_explicit(&STORAGE(vec->data_)->refs_, 1, memory_order_acq_rel) == 1)
+    {
+        destroy_elements(vec, 0, vec->size_);
+        free_storage(vec->data_);
+    }
+
+    vec->data_ = NULL;
+    vec->size_ = 0;
+    vec->capacity_ = 0;
+}
+
+/**
+ * @brief Gives a vector its own copy of shared elements. Copies before
+ *        letting go, so the other side never sees the elements destroyed
+ *        while they're being read.
+ * 
+ * @param vec 
+ * @return true 
+ * @return false 
+ */
+bool vector_detach(vector* vec)
+{
+    unsigned char* temp;
+
+    if (!vec) return false;
+    if (!shared(vec)) return true;
+
+    temp = alloc_storage(vec->capacity_, vec->data_size_);
+    if (!temp) return false;
+
+    copy_elements(vec, temp, vec->data_, vec->size_);
+
+    /* everyone else let go while we were copying */
+    if (atomic_fetch_sub_explicit(&STORAGE(vec->data_)->refs_, 1, memory_order_acq_rel) == 1)
+    {
+        destroy_elements(vec, 0, vec->size_);
+        free_storage(vec->data_);
+    }
+
+    vec->data_ = temp;
+
+    return true;
+}
+
+/**
+ * @brief Frees allocated memory. Arena vectors only destroy their elements,
+ *        the memory goes back when the arena is reset. Mapped vectors record
+ *        their size and close the file.
  * 
  * @param vec
- * @param preserve_data
  */
 void free_vector(vector** vec)
 {
-    /* iterator */
-    unsigned i;
-
     if (vec && *vec)
     {
-        /* free memory */
-        for (i = 0; i < (*vec)->capacity_; ++i)
-            if ((*vec)->data_[i])
-                free((*vec)->data_[i]);
-
-        free((*vec)->data_);
-        free((*vec)->data_type_);
-        free(*vec);
+        release_elements(*vec);
+
+        if (!(*vec)->arena_)
+            free(*vec);
+
         *vec = NULL;
     }
 }
 
 /**
- * @brief Frees a vector, but preserves data.
+ * @brief Reallocates the elements to an exact capacity, keeping the header.
  * 
  * @param vec 
+ * @param capacity 
+ * @return true 
+ * @return false 
  */
-static void free_vector_preserve(vector** vec)
+static bool set_capacity(vector* vec, size_t capacity)
 {
-    if (vec && *vec)
+    unsigned char* temp;
+
+    if (vec->file_)
     {
-        free((*vec)->data_);
-        free((*vec)->data_type_);
-        free(*vec);
-        *vec = NULL;
+        /* the file grows with the vector */
+        if (!file_resize(vec->file_, capacity)) return false;
+
+        vec->data_ = file_data(vec->file_);
+        vec->capacity_ = capacity;
+        return true;
     }
+
+    if (capacity > STORAGE_MAX(vec->data_size_)) return false;
+
+    if (!capacity)
+    {
+        if (!vec->arena_) free_storage(vec->data_);
+        vec->data_ = NULL;
+        vec->capacity_ = 0;
+        return true;
+    }
+
+    if (vec->arena_)
+    {
+        /* the newest allocation grows (or shrinks) in place, anything else
+           moves, and shrinking elsewhere just leaves the tail unused */
+        if (arena_extend(vec->arena_, vec->data_, capacity * vec->data_size_) ||
+            capacity < vec->capacity_)
+        {
+            vec->capacity_ = capacity;
+            return true;
+        }
+
+        temp = arena_alloc(vec->arena_, capacity * vec->data_size_, vec->type_->alignment_);
+        if (!temp) return false;
+
+        if (vec->size_)
+            memcpy(temp, vec->data_, vec->size_ * vec->data_size_);
+    }
+    else if (!vec->data_)
+    {
+        temp = alloc_storage(capacity, vec->data_size_);
+        if (!temp) return false;
+    }
+    else
+    {
+        temp = realloc(vec->data_ - STORAGE_HEADER, STORAGE_HEADER + capacity * vec->data_size_);
+        if (!temp) return false;
+        temp += STORAGE_HEADER;
+    }
+
+    vec->data_ = temp;
+    vec->capacity_ = capacity;
+
+    return true;
+}
+
+/**
+ * @brief Makes sure count more elements fit, growing the capacity at most
+ *        once. Grows by the growth factor, or straight to the size needed.
+ * 
+ * @param vec 
+ * @param count 
+ * @return true 
+ * @return false 
+ */
+static bool make_room(vector* vec, size_t count)
+{
+    size_t needed = vec->size_ + count;
+    size_t capacity;
+    double grown;
+
+    /* overflow */
+    if (needed < vec->size_) return false;
+    if (needed <= vec->capacity_) return true;
+
+    grown = (double)vec->capacity_ * vec->growth_;
+    capacity = grown < (double)(SIZE_MAX / vec->data_size_) ? (size_t)grown : needed;
+    if (capacity <= vec->capacity_)
+        capacity = vec->capacity_ ? vec->capacity_ + 1 : DEFAULT_CAPACITY;
+    if (capacity < needed)
+        capacity = needed;
+
+    return set_capacity(vec, capacity);
+}
+
+/**
+ * @brief Checks if data points at the vector's own elements.
+ * 
+ * @param vec 
+ * @param data 
+ * @return true 
+ * @return false 
+ */
+static bool owns(const vector* vec, const void* data)
+{
+    const unsigned char* bytes = data;
+
+    return vec->data_ && bytes >= vec->data_ &&
+           bytes < vec->data_ + vec->size_ * vec->data_size_;
+}
+
+/**
+ * @brief Makes room for count more elements, growing the capacity in place
+ *        (and detaching shared elements). data may point into the vector,
+ *        it's returned relocated.
+ * 
+ * @param vec 
+ * @param data 
+ * @param count 
+ * @return const void* (NULL on failure)
+ */
+static const void* grow(vector* vec, const void* data, size_t count)
+{
+    /* the data being pushed may be our own elements */
+    bool inside = owns(vec, data);
+    size_t offset = inside ? (size_t)((const unsigned char*)data - vec->data_) : 0;
+
+    if (!vector_detach(vec) || !make_room(vec, count)) return NULL;
+
+    return inside ? vec->data_ + offset : data;
+}
+
+/**
+ * @brief Pushes back.
+ * 
+ * @param vec 
+ * @param data 
+ * @return true 
+ * @return false 
+ */
+bool vector_push_back(vector* vec, const void* data)
+{
+    if (!vec || !data) return false;
+
+    data = grow(vec, data, 1);
+    if (!data) return false;
+
+    copy_elements(vec, vec->data_ + vec->size_ * vec->data_size_, data, 1);
+    ++vec->size_;
+
+    return true;
 }
 
 /**
@@ -146,103 +830,190 @@ static void free_vector_preserve(vector** vec)
  */
 void push_back(vector** vec, const void* data)
 {
-    /* used for allocating additional memory if necessary */
-    vector* temp = NULL;
-    void* dat = NULL;
+    if (vec) vector_push_back(*vec, data);
+}
 
-    if (!vec || !(*vec) || !data) return;
+/**
+ * @brief Pushes front.
+ * 
+ * @param vec 
+ * @param data 
+ * @return true 
+ * @return false 
+ */
+bool vector_push_front(vector* vec, const void* data)
+{
+    const unsigned char* bytes;
+    size_t bytes_used;
 
-    dat = malloc((*vec)->data_size_);
-    if (!dat) return;
-    memcpy(dat, data, (*vec)->data_size_); 
-    
-    if ((*vec)->size_ == (*vec)->capacity_)
-    {
-        temp = alloc_vector((*vec)->capacity_ * 2, (*vec)->data_size_, (*vec)->data_type_, (*vec)->pf_);
+    if (!vec || !data) return false;
 
-        if (temp)
-        {
-            /* copy values */
-            copy_vector_shallow(&temp, *vec);
+    bytes = grow(vec, data, 1);
+    if (!bytes) return false;
 
-            /* set */
-            temp->data_[(*vec)->size_] = dat;
-            ++temp->size_;
+    bytes_used = vec->size_ * vec->data_size_;
 
-            /* free the old vector */
-            free_vector_preserve(vec);
+    /* shift everything over by one element */
+    memmove(vec->data_ + vec->data_size_, vec->data_, bytes_used);
 
-            /* set new */
-            *vec = temp;
-        }
-        else
-        {
-            /* free allocated memory */
-            free(dat);
-        }
+    /* our own elements moved along with the rest */
+    if (bytes >= vec->data_ && bytes < vec->data_ + bytes_used)
+        bytes += vec->data_size_;
+
+    copy_elements(vec, vec->data_, bytes, 1);
+    ++vec->size_;
+
+    return true;
+}
+
+/**
+ * @brief Pushes front.
+ * 
+ * @param vec 
+ * @param data 
+ */
+void push_front(vector** vec, const void* data)
+{
+    if (vec) vector_push_front(*vec, data);
+}
+
+/**
+ * @brief Inserts count elements before index, shifting the rest once.
+ *        data may be a range of the vector's own elements.
+ * 
+ * @param vec 
+ * @param index (size inserts at the back)
+ * @param data 
+ * @param count 
+ * @return true 
+ * @return false 
+ */
+bool vector_insert_range(vector* vec, size_t index, const void* data, size_t count)
+{
+    const unsigned char* bytes;
+    unsigned char* at;
+    size_t before, length;
+
+    if (!vec || index > vec->size_ || (count && !data)) return false;
+    if (!count) return true;
+
+    bytes = grow(vec, data, count);
+    if (!bytes) return false;
+
+    at = vec->data_ + index * vec->data_size_;
+    length = count * vec->data_size_;
+
+    /* open the gap */
+    memmove(at + length, at, (vec->size_ - index) * vec->data_size_);
+
+    if (owns(vec, bytes))
+    {
+        /* the part of the source past the gap moved along with the rest */
+        before = bytes < at ? (size_t)(at - bytes) : 0;
+        if (before > length) before = length;
+
+        copy_elements(vec, at, bytes, before / vec->data_size_);
+        copy_elements(vec, at + before, (bytes < at ? at : bytes) + length,
+                      (length - before) / vec->data_size_);
     }
     else
     {
-        /* add in data */
-        (*vec)->data_[(*vec)->size_++] = dat;
+        copy_elements(vec, at, bytes, count);
     }
+
+    vec->size_ += count;
+
+    return true;
+}
+
+/**
+ * @brief Appends count elements.
+ * 
+ * @param vec 
+ * @param data 
+ * @param count 
+ * @return true 
+ * @return false 
+ */
+bool vector_push_back_n(vector* vec, const void* data, size_t count)
+{
+    if (!vec) return false;
+
+    return vector_insert_range(vec, vec->size_, data, count);
+}
+
+/**
+ * @brief Removes count elements starting at first, shifting the rest once.
+ * 
+ * @param vec 
+ * @param first 
+ * @param count 
+ * @return true 
+ * @return false 
+ */
+bool vector_erase_range(vector* vec, size_t first, size_t count)
+{
+    if (!vec || first > vec->size_ || count > vec->size_ - first) return false;
+    if (!count) return true;
+    if (!vector_detach(vec)) return false;
+
+    destroy_elements(vec, first, first + count);
+
+    /* shift elements */
+    memmove(vec->data_ + first * vec->data_size_,
+            vec->data_ + (first + count) * vec->data_size_,
+            (vec->size_ - first - count) * vec->data_size_);
+
+    vec->size_ -= count;
+
+    return true;
 }
 
 /**
- * @brief Pushes front.
+ * @brief Replaces the contents with count elements. data may be a range of
+ *        the vector's own elements.
  * 
  * @param vec 
  * @param data 
+ * @param count 
+ * @return true 
+ * @return false 
  */
-void push_front(vector** vec, const void* data)
+bool vector_assign(vector* vec, const void* data, size_t count)
 {
-    /* iter */
-    int i;
-    /* used for allocating additional memory if necessary */
-    vector* temp = NULL;
-    void* dat = NULL;
+    size_t first;
 
-    if (!vec || !(*vec) || !data) return;
+    if (!vec || (count && !data)) return false;
 
-    dat = malloc((*vec)->data_size_);
-    if (!dat) return;
-    memcpy(dat, data, (*vec)->data_size_); 
-
-    if ((*vec)->size_ == (*vec)->capacity_)
+    if (count && owns(vec, data))
     {
-        temp = alloc_vector((*vec)->capacity_ * 2, (*vec)->data_size_, (*vec)->data_type_, (*vec)->pf_);
+        first = (size_t)((const unsigned char*)data - vec->data_) / vec->data_size_;
+        if (count > vec->size_ - first) return false;
 
-        if (temp)
-        {
-            /* copy values */
-            copy_vector_shallow(&temp, *vec);
+        if (!vector_detach(vec)) return false;
+        data = vec->data_ + first * vec->data_size_;
 
-            for (i = (*vec)->size_; i >= 0; --i)
-                temp->data_[i + 1] = temp->data_[i];          
+        /* keep the range, drop everything around it */
+        destroy_elements(vec, 0, first);
+        destroy_elements(vec, first + count, vec->size_);
+        memmove(vec->data_, data, count * vec->data_size_);
+        vec->size_ = count;
 
-            /* set */
-            temp->data_[0] = dat;
-            ++temp->size_;
+        return true;
+    }
 
-            /* free the old vector */
-            free_vector_preserve(vec);
+    /* shared elements are about to be replaced, no point copying them */
+    if (shared(vec))
+        release_elements(vec);
 
-            /* set new */
-            *vec = temp;
-        }
-        else
-        {
-            /* free allocated memory */
-            free(dat);
-        }
-    }
-    else
-    {
-        for (i = (*vec)->size_; i >= 0; --i)
-            (*vec)->data_[i + 1] = (*vec)->data_[i];
-        (*vec)->data_[0] = dat;
-        ++(*vec)->size_;
-    }
+    if (count > vec->capacity_ && !set_capacity(vec, count)) return false;
+
+    destroy_elements(vec, 0, vec->size_);
+    if (count)
+        copy_elements(vec, vec->data_, data, count);
+    vec->size_ = count;
+
+    return true;
 }
 
 /**
@@ -272,87 +1043,86 @@ void pop_front(vector* vec)
 }
 
 /**
- * @brief Copies from one vector into another.
+ * @brief Copies from one vector into another of the same type. Heap vectors
+ *        share the elements until either side changes them, so this is O(1).
  * 
  * @param destination 
  * @param source 
+ * @return true 
+ * @return false 
  */
-void copy_vector(vector** destination, const vector* source)
+bool vector_copy(vector* destination, const vector* source)
 {
-    /* loop iter */
-    unsigned i;
-    int j;
-
     /* safety check */
-    if (!destination || !source) return;
+    if (!destination || !source || destination->type_ != source->type_) return false;
+    if (destination == source || (source->data_ && destination->data_ == source->data_)) return true;
 
-    /* allocate additional memory if necessary */
-    if (!(*destination) || (*destination)->capacity_ < source->size_)
+    if (on_heap(destination) && on_heap(source) && source->data_)
     {
-        free_vector(destination);
-        *destination = alloc_vector(source->size_, source->data_size_, source->data_type_, source->pf_);
-        if (!(*destination)) return;
+        atomic_fetch_add_explicit(&STORAGE(source->data_)->refs_, 1, memory_order_relaxed);
+
+        release_elements(destination);
+        destination->data_ = source->data_;
+        destination->size_ = source->size_;
+        destination->capacity_ = source->capacity_;
+
+        return true;
     }
 
+    /* arena and file elements can't be shared, copy them */
+    if (shared(destination))
+        release_elements(destination);
+
+    /* allocate additional memory if necessary */
+    if (destination->capacity_ < source->size_ && !set_capacity(destination, source->size_))
+        return false;
+
+    /* replace the old elements */
+    destroy_elements(destination, 0, destination->size_);
+    destination->size_ = 0;
+
     /* copy data */
-    for (i = 0; i < source->size_; ++i)
-    {
-        /* allocate memory */
-        (*destination)->data_[i] = malloc(source->data_size_);
+    if (source->size_)
+        copy_elements(source, destination->data_, source->data_, source->size_);
 
-        if (!(*destination)->data_[i])
-        {
-            if (i)
-            {
-                j = i - 1;
-
-                /* malloc failed, free all previously allocated memory, and return */
-                for (; j >= 0; --j)
-                    free((*destination)->data_[j]);
-            }
-
-            /* free the vector that was allocated (data should have been deallocated) */
-            free_vector_preserve(destination);
-            return;
-        }
-        else
-        {
-            memcpy((*destination)->data_[i], source->data_[i], source->data_size_); 
-        }     
-    }
-    
     /* set the size */
-    (*destination)->size_ = source->size_;
+    destination->size_ = source->size_;
+
+    return true;
 }
 
 /**
- * @brief Copies from one vector into another.
+ * @brief Copies from one vector into another, allocating the destination
+ *        if it doesn't exist or holds a different type. Heap copies share
+ *        the elements, so pointers from vector_get and vector_data point
+ *        at both vectors' elements: call vector_detach on the one being
+ *        written before writing through them.
  * 
  * @param destination 
  * @param source 
  */
-static void copy_vector_shallow(vector** destination, const vector* source)
+void copy_vector(vector** destination, const vector* source)
 {
-    /* loop iter */
-    unsigned i;
+    arena* a;
 
     /* safety check */
-    if (!destination || !source) return;
+    if (!destination || !source || *destination == source) return;
 
-    /* allocate additional memory if necessary */
-    if (!(*destination) || (*destination)->capacity_ < source->size_)
+    if (!(*destination) || (*destination)->type_ != source->type_)
     {
+        /* a replacement stays in the same arena */
+        a = *destination ? (*destination)->arena_ : NULL;
+
         free_vector(destination);
-        *destination = alloc_vector(source->size_, source->data_size_, source->data_type_, source->pf_);
+
+        /* heap copies share the source's elements, they don't need any */
+        *destination = create_vector(a, source->size_, source->type_, a || !on_heap(source));
         if (!(*destination)) return;
+        (*destination)->pf_ = source->pf_;
     }
 
-    /* copy data */
-    for (i = 0; i < source->size_; ++i)
-        (*destination)->data_[i] = source->data_[i];
-    
-    /* set the size */
-    (*destination)->size_ = source->size_;
+    if (!vector_copy(*destination, source))
+        free_vector(destination);
 }
 
 /**
@@ -362,20 +1132,17 @@ static void copy_vector_shallow(vector** destination, const vector* source)
  */
 void clear_vector(vector* vec)
 {
-    /* iterator */
-    unsigned i;
-
     if (!vec) return;
 
-    for (i = 0; i < vec->size_; ++i)
+    /* let go of shared elements instead of copying them */
+    if (shared(vec))
     {
-        if (vec->data_[i])
-        {
-            free(vec->data_[i]);
-            vec->data_[i] = NULL;
-        }
+        release_elements(vec);
+        return;
     }
 
+    destroy_elements(vec, 0, vec->size_);
+
     /* set the size to 0 */
     vec->size_ = 0;
 }
@@ -398,9 +1165,9 @@ bool empty(const vector* vec)
  * @brief Returns the size of a vector.
  * 
  * @param vec 
- * @return unsigned 
+ * @return size_t 
  */
-unsigned size(const vector* vec)
+size_t size(const vector* vec)
 {
     if (!vec) return 0;
 
@@ -411,15 +1178,28 @@ unsigned size(const vector* vec)
  * @brief Returns the capacity of a vector.
  * 
  * @param vec 
- * @return unsigned 
+ * @return size_t 
  */
-unsigned capacity(const vector* vec)
+size_t capacity(const vector* vec)
 {
     if (!vec) return 0;
 
     return vec->capacity_;
 }
 
+/**
+ * @brief Resizes the vector to not waste memory.
+ * 
+ * @param vec 
+ */
+void vector_shrink_to_fit(vector* vec)
+{
+    if (!vec || !vector_detach(vec)) return;
+
+    if (vec->capacity_ > vec->size_)
+        set_capacity(vec, vec->size_);
+}
+
 /**
  * @brief Resizes the vector to not waste memory.
  * 
@@ -427,58 +1207,109 @@ unsigned capacity(const vector* vec)
  */
 void shrink_to_fit(vector** vec)
 {
-    vector* temp = NULL;
+    if (vec) vector_shrink_to_fit(*vec);
+}
+
+/**
+ * @brief Makes room for at least capacity elements.
+ * 
+ * @param vec 
+ * @param capacity 
+ * @return true 
+ * @return false 
+ */
+bool vector_reserve(vector* vec, size_t capacity)
+{
+    if (!vec) return false;
 
-    if (!vec || !(*vec)) return;
+    if (capacity <= vec->capacity_) return true;
+    if (!vector_detach(vec)) return false;
 
-    if ((*vec)->capacity_ > (*vec)->size_)
-    {
-        temp = alloc_vector((*vec)->size_, (*vec)->data_size_, (*vec)->data_type_, (*vec)->pf_);
-        if (temp)
-        {
-            copy_vector_shallow(&temp, *vec);
-            free_vector_preserve(vec);
-            *vec = temp;
-        }
-    }
+    return set_capacity(vec, capacity);
 }
 
 /**
- * @brief Removes an element from the vector.
+ * @brief Sets the number of elements. New elements are zeroed, so a type's
+ *        destroy callback has to accept an all zero element.
  * 
  * @param vec 
+ * @param size 
+ * @return true 
+ * @return false 
  */
-void remove_element(vector* vec, unsigned index)
+bool vector_resize(vector* vec, size_t size)
 {
-    /* iterator variable */
-    unsigned i;
+    if (!vec || !vector_detach(vec)) return false;
 
-    /* safety checking */
-    if (!vec || index >= vec->size_) return;
+    if (size > vec->capacity_ && !set_capacity(vec, size)) return false;
+
+    if (size > vec->size_)
+        memset(vec->data_ + vec->size_ * vec->data_size_, 0,
+               (size - vec->size_) * vec->data_size_);
+    else
+        destroy_elements(vec, size, vec->size_);
 
-    /* free memory */
-    free(vec->data_[index]);
-    vec->data_[index] = NULL;
+    vec->size_ = size;
 
-    /* shift elements */
-    for (i = index; i < (vec->size_ - 1); ++i)
-        vec->data_[i] = vec->data_[i + 1];
+    return true;
+}
+
+/**
+ * @brief Sets how much the capacity is multiplied by when the vector is full.
+ * 
+ * @param vec 
+ * @param factor (must be above 1)
+ * @return true 
+ * @return false 
+ */
+bool vector_set_growth_factor(vector* vec, float factor)
+{
+    if (!vec || !(factor > 1.0f)) return false;
+
+    vec->growth_ = factor;
 
-    --vec->size_;
+    return true;
 }
 
 /**
- * @brief Gets a requested value.
+ * @brief Removes an element from the vector.
+ * 
+ * @param vec 
+ */
+void remove_element(vector* vec, size_t index)
+{
+    /* safety checking */
+    if (!vec || index >= vec->size_) return;
+
+    vector_erase_range(vec, index, 1);
+}
+
+/**
+ * @brief Gets a requested value. The pointer is valid until the vector grows.
  * 
  * @param vec 
  * @param index 
  * @return void* 
  */
-void* vector_get(const vector* vec, unsigned index)
+void* vector_get(const vector* vec, size_t index)
 {
     if (!vec || index >= vec->size_) return NULL;
 
-    return vec->data_[index];
+    return vec->data_ + index * vec->data_size_;
+}
+
+/**
+ * @brief Gets all elements as one contiguous array. The pointer is valid
+ *        until the vector grows.
+ * 
+ * @param vec 
+ * @return void* 
+ */
+void* vector_data(const vector* vec)
+{
+    if (!vec) return NULL;
+
+    return vec->data_;
 }
 
 /**
@@ -489,7 +1320,7 @@ void* vector_get(const vector* vec, unsigned index)
 void print_data_type(const vector* vec)
 {
     if (!vec) return;
-    printf("%s\n", vec->data_type_);
+    printf("%s\n", vec->type_->name_);
 }
 
 /**
@@ -517,5 +1348,254 @@ bool check_type(const vector* vec, const char* type)
 {
     if (!vec || !type) return false;
 
-    return (!strcmp(vec->data_type_, type));
+    return vec->type_->name_ == type || !strcmp(vec->type_->name_, type);
+}
+
+/**
+ * @brief Checks a type of the vector against a registered type.
+ * 
+ * @param vec 
+ * @param type 
+ * @return true 
+ * @return false 
+ */
+bool check_type_of(const vector* vec, const vector_type* type)
+{
+    return vec && vec->type_ == type;
+}
+
+/**
+ * @brief Returns the registered type of a vector.
+ * 
+ * @param vec 
+ * @return const vector_type* 
+ */
+const vector_type* vector_type_of(const vector* vec)
+{
+    return vec ? vec->type_ : NULL;
+}
+
+/**
+ * @brief Finds the first element equal to key. Uses SIMD kernels for 1, 2, 4
+ *        and 8 byte elements.
+ * 
+ * @param vec 
+ * @param key 
+ * @return size_t (the size if there is none)
+ */
+size_t vector_find(const vector* vec, const void* key)
+{
+    if (!vec) return 0;
+
+    return simd_find(vec->data_, vec->size_, vec->data_size_, key);
+}
+
+/**
+ * @brief Counts the elements equal to key.
+ * 
+ * @param vec 
+ * @param key 
+ * @return size_t 
+ */
+size_t vector_count(const vector* vec, const void* key)
+{
+    if (!vec) return 0;
+
+    return simd_count(vec->data_, vec->size_, vec->data_size_, key);
+}
+
+/**
+ * @brief Finds the smallest and largest element.
+ * 
+ * @param vec 
+ * @param kind 
+ * @param min (may be NULL)
+ * @param max (may be NULL)
+ * @return true 
+ * @return false (empty, or not 1, 2, 4 or 8 byte numbers)
+ */
+bool vector_min_max(const vector* vec, vector_kind kind, void* min, void* max)
+{
+    if (!vec) return false;
+
+    return simd_min_max(vec->data_, vec->size_, vec->data_size_, kind, min, max);
+}
+
+/**
+ * @brief Sums the elements. Integers wrap around at 64 bits.
+ * 
+ * @param vec 
+ * @param kind 
+ * @param sum (int64_t, uint64_t or double, matching the kind)
+ * @return true 
+ * @return false 
+ */
+bool vector_sum(const vector* vec, vector_kind kind, void* sum)
+{
+    if (!vec) return false;
+
+    return simd_sum(vec->data_, vec->size_, vec->data_size_, kind, sum);
+}
+
+/**
+ * @brief Sorts the elements in place.
+ * 
+ * @param vec 
+ * @param compare 
+ */
+void vector_sort(vector* vec, COMPAREFUNC compare)
+{
+    if (!vec || !compare || vec->size_ < 2 || !vector_detach(vec)) return;
+
+    qsort(vec->data_, vec->size_, vec->data_size_, compare);
+}
+
+/**
+ * @brief Sorts the elements by a number stored inside each of them. Stable.
+ *        Needs a second buffer the size of the vector.
+ * 
+ * @param vec 
+ * @param key_offset (where the key starts in an element)
+ * @param key_size (1, 2, 4 or 8 bytes, 4 or 8 for VECTOR_FLOAT)
+ * @param kind 
+ * @param threads (0 = one per processor)
+ * @return true 
+ * @return false 
+ */
+bool vector_sort_keys(vector* vec, unsigned key_offset, unsigned key_size, vector_kind kind,
+                      unsigned threads)
+{
+    unsigned char* scratch;
+    void* sorted;
+
+    if (!vec || key_offset >= vec->data_size_ || key_size > vec->data_size_ - key_offset)
+        return false;
+    if (vec->size_ < 2) return true;
+    if (!vector_detach(vec)) return false;
+
+    scratch = alloc_storage(vec->capacity_, vec->data_size_);
+    if (!scratch) return false;
+
+    sorted = radix_sort(vec->data_, scratch, vec->size_, vec->data_size_, key_offset, key_size,
+                        kind, threads);
+
+    /* keep whichever buffer holds the result */
+    if (sorted == scratch && !on_heap(vec))
+    {
+        memcpy(vec->data_, scratch, vec->size_ * vec->data_size_);
+        free_storage(scratch);
+    }
+    else if (sorted == scratch)
+    {
+        free_storage(vec->data_);
+        vec->data_ = scratch;
+    }
+    else
+    {
+        free_storage(scratch);
+    }
+
+    return sorted ? true : false;
+}
+
+/**
+ * @brief Finds the first element that isn't less than key. The comparator
+ *        gets the element first and the key second.
+ * 
+ * @param vec 
+ * @param key 
+ * @param compare 
+ * @return size_t (the size if every element is less)
+ */
+size_t vector_lower_bound(const vector* vec, const void* key, COMPAREFUNC compare)
+{
+    size_t first = 0, count, step;
+
+    if (!vec) return 0;
+    if (!key || !compare) return vec->size_;
+
+    for (count = vec->size_; count; )
+    {
+        step = count / 2;
+
+        if (compare(vec->data_ + (first + step) * vec->data_size_, key) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+/**
+ * @brief Finds the first element that's greater than key. The comparator
+ *        gets the element first and the key second.
+ * 
+ * @param vec 
+ * @param key 
+ * @param compare 
+ * @return size_t (the size if no element is greater)
+ */
+size_t vector_upper_bound(const vector* vec, const void* key, COMPAREFUNC compare)
+{
+    size_t first = 0, count, step;
+
+    if (!vec) return 0;
+    if (!key || !compare) return vec->size_;
+
+    for (count = vec->size_; count; )
+    {
+        step = count / 2;
+
+        if (compare(vec->data_ + (first + step) * vec->data_size_, key) <= 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+/**
+ * @brief Removes every element equal to the one kept before it, in one pass.
+ * 
+ * @param vec 
+ * @param compare 
+ * @return size_t (the new size)
+ */
+size_t vector_unique(vector* vec, COMPAREFUNC compare)
+{
+    size_t read, write = 0;
+    unsigned char* element;
+
+    if (!vec) return 0;
+    if (!compare || vec->size_ < 2 || !vector_detach(vec)) return vec->size_;
+
+    for (read = 1; read < vec->size_; ++read)
+    {
+        element = vec->data_ + read * vec->data_size_;
+
+        if (!compare(vec->data_ + write * vec->data_size_, element))
+        {
+            destroy_elements(vec, read, read + 1);
+            continue;
+        }
+
+        if (++write != read)
+            memcpy(vec->data_ + write * vec->data_size_, element, vec->data_size_);
+    }
+
+    vec->size_ = write + 1;
+
+    return vec->size_;
 }
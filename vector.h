@@ -8,16 +8,47 @@
 
 #pragma once
 
+#include "arena.h" /* arena */
+
 /* define boolean values */
+#ifndef BOOL_DEFINED
+#define BOOL_DEFINED
 typedef enum {false = 0, true = 1} bool;
+#endif
 /* opaque struct pointer */
 typedef struct vector vector;
 /* typedef for printing function */
 typedef void (*PRINTFUNC)(const vector*);
+/* registered element type (interned, compare by pointer) */
+typedef struct vector_type vector_type;
+/* copy constructs an element into uninitialized memory */
+typedef void (*COPYFUNC)(void* destination, const void* source);
+/* releases whatever an element owns */
+typedef void (*DESTROYFUNC)(void* element);
+/* how vector_min_max and vector_sum read the elements */
+typedef enum {VECTOR_SIGNED, VECTOR_UNSIGNED, VECTOR_FLOAT} vector_kind;
+/* orders two elements, like qsort's comparator */
+typedef int (*COMPAREFUNC)(const void* a, const void* b);
+
+/* registers a type, or returns the same one registered before (NULL if it differs) */
+const vector_type* register_type(const char* name, unsigned size, unsigned alignment,
+                                 PRINTFUNC print, COPYFUNC copy, DESTROYFUNC destroy);
+/* finds a registered type by name */
+const vector_type* find_type(const char* name);
+/* allocates a vector of a registered type */
+vector* alloc_vector_of(size_t capacity, const vector_type* type);
+/* allocates a vector out of an arena (freed all at once by arena_reset) */
+vector* alloc_vector_in(arena* a, size_t capacity, unsigned data_size, const char* data_type,
+                        PRINTFUNC func);
 
 /* allocates a vector */
-vector* alloc_vector(unsigned capacity, unsigned data_size, const char* data_type, PRINTFUNC func);
-/* frees a vector */
+vector* alloc_vector(size_t capacity, unsigned data_size, const char* data_type, PRINTFUNC func);
+/* maps a vector onto a file that grows with it, data_type NULL = what the file holds */
+vector* vector_map_file(const char* path, unsigned data_size, const char* data_type,
+                        PRINTFUNC func);
+/* writes a vector to a file vector_map_file can open (not its own mapped file) */
+bool vector_save(const vector* vec, const char* path);
+/* frees a vector (a mapped one records its size and closes the file) */
 void free_vector(vector** vec);
 /* pushes back into a vector */
 void push_back(vector** vec, const void* data);
@@ -27,25 +58,73 @@ void push_front(vector** vec, const void* data);
 void pop_back(vector* vec);
 /* pops the front of a vector */
 void pop_front(vector* vec);
-/* deep copies a vector */
+/* copies a vector (shares the elements until either side changes them, so
+   call vector_detach before writing through vector_get or vector_data) */
 void copy_vector(vector** destination, const vector* source);
 /* clears a vector */
 void clear_vector(vector* vec);
 /* returns whether or not the vector is empty */
 bool empty(const vector* vec);
 /* returns the size of the vector */
-unsigned size(const vector* vec);
+size_t size(const vector* vec);
 /* returns the capacity of the vector */
-unsigned capacity(const vector* vec);
+size_t capacity(const vector* vec);
 /* matches the capacity of a vector to its size */
 void shrink_to_fit(vector** vec);
 /* removes an element at an index */
-void remove_element(vector* vec, unsigned index);
-/* gets an element */
-void* vector_get(const vector* vec, unsigned index);
+void remove_element(vector* vec, size_t index);
+/* gets an element (call vector_detach before writing through it) */
+void* vector_get(const vector* vec, size_t index);
+/* gets the elements as one contiguous array (vector_detach before writing) */
+void* vector_data(const vector* vec);
+/* gives a vector its own copy of elements it shares with copies of it */
+bool vector_detach(vector* vec);
 /* prints the data type of a vector */
 void print_data_type(const vector* vec);
 /* dumps the contents of a vector */
 void dump_vector(const vector* vec);
 /* checks the type of the vector */
 bool check_type(const vector* vec, const char* type);
+/* checks the type of the vector against a registered type */
+bool check_type_of(const vector* vec, const vector_type* type);
+/* returns the registered type of the vector */
+const vector_type* vector_type_of(const vector* vec);
+
+/* vector* versions of the calls above (the header never moves) */
+bool vector_push_back(vector* vec, const void* data);
+bool vector_push_front(vector* vec, const void* data);
+bool vector_copy(vector* destination, const vector* source);
+void vector_shrink_to_fit(vector* vec);
+/* makes room for at least capacity elements */
+bool vector_reserve(vector* vec, size_t capacity);
+/* sets the number of elements, new ones are zeroed */
+bool vector_resize(vector* vec, size_t size);
+/* sets how much the capacity grows by when full (default 2) */
+bool vector_set_growth_factor(vector* vec, float factor);
+/* inserts count elements before index */
+bool vector_insert_range(vector* vec, size_t index, const void* data, size_t count);
+/* removes count elements starting at first */
+bool vector_erase_range(vector* vec, size_t first, size_t count);
+/* appends count elements */
+bool vector_push_back_n(vector* vec, const void* data, size_t count);
+/* replaces the contents with count elements */
+bool vector_assign(vector* vec, const void* data, size_t count);
+/* finds the first element equal to key (size if there is none) */
+size_t vector_find(const vector* vec, const void* key);
+/* counts the elements equal to key */
+size_t vector_count(const vector* vec, const void* key);
+/* finds the smallest and largest element (1, 2, 4 or 8 byte numbers) */
+bool vector_min_max(const vector* vec, vector_kind kind, void* min, void* max);
+/* sums the elements into a 64 bit integer, or a double for VECTOR_FLOAT */
+bool vector_sum(const vector* vec, vector_kind kind, void* sum);
+/* sorts the elements with a comparator */
+void vector_sort(vector* vec, COMPAREFUNC compare);
+/* radix sorts the elements by a 1, 2, 4 or 8 byte key (threads 0 = one per processor) */
+bool vector_sort_keys(vector* vec, unsigned key_offset, unsigned key_size, vector_kind kind,
+                      unsigned threads);
+/* finds the first element not less than key in a sorted vector */
+size_t vector_lower_bound(const vector* vec, const void* key, COMPAREFUNC compare);
+/* finds the first element greater than key in a sorted vector */
+size_t vector_upper_bound(const vector* vec, const void* key, COMPAREFUNC compare);
+/* removes consecutive equal elements, returns the new size */
+size_t vector_unique(vector* vec, COMPAREFUNC compare);
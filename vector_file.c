@@ -0,0 +1,467 @@
+/******************************************************************************/
+/*
+* @file   vector_file.c
+* @author Aditya Harsh
+* @brief  Vector files. A fixed header describing the elements, followed by
+*         the elements themselves, so a file can be mapped and used as is.
+*/
+/******************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* mremap */
+#endif
+
+#include "vector_file.h" /* vector file interface       */
+#include <stdlib.h>      /* malloc, free                */
+#include <stdio.h>       /* fopen, fwrite, fclose       */
+#include <string.h>      /* memcpy, memset, strlen, ... */
+#include <stdint.h>      /* uint32_t, uint64_t          */
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>       /* open                        */
+#include <unistd.h>      /* ftruncate, pread, unlink    */
+#include <sys/mman.h>    /* mmap, mremap, munmap        */
+#include <sys/stat.h>    /* fstat, stat                 */
+#include <errno.h>       /* errno, ENOENT, EEXIST       */
+#define VECTOR_FILE_MAP
+#endif
+
+/* bumped whenever the layout changes */
+#define FILE_VERSION 1
+/* reads back differently on a machine with the other byte order */
+#define FILE_ENDIAN 0x01020304u
+
+/* the first bytes of every vector file */
+static const char file_magic[8] = {'V', 'E', 'C', 'T', 'O', 'R', '\0', '\0'};
+
+/**
+ * @brief What the first VECTOR_FILE_HEADER bytes of a file hold, the rest
+ *        is zero.
+ *
+ */
+typedef struct
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t endian_;
+    /* the size of one element */
+    uint32_t data_size_;
+    uint32_t reserved_;
+    /* the number of elements in use (the file may hold more) */
+    uint64_t size_;
+    /* the type name, zero terminated */
+    char type_[VECTOR_FILE_TYPE];
+} file_header;
+
+/**
+ * @brief Fills in a header.
+ *
+ * @param header (VECTOR_FILE_HEADER bytes)
+ * @param data_size
+ * @param data_type
+ * @param size
+ */
+static void write_header(unsigned char* header, unsigned data_size, const char* data_type,
+                         size_t size)
+{
+    file_header fields;
+
+    memset(&fields, 0, sizeof(fields));
+    memcpy(fields.magic_, file_magic, sizeof(file_magic));
+    fields.version_ = FILE_VERSION;
+    fields.endian_ = FILE_ENDIAN;
+    fields.data_size_ = data_size;
+    fields.size_ = size;
+    strcpy(fields.type_, data_type);
+
+    memset(header, 0, VECTOR_FILE_HEADER);
+    memcpy(header, &fields, sizeof(fields));
+}
+
+/**
+ * @brief Returns the bytes a file needs for capacity elements.
+ *
+ * @param data_size
+ * @param capacity
+ * @param bytes
+ * @return true
+ * @return false (it doesn't fit in a size_t)
+ */
+static bool file_bytes(unsigned data_size, size_t capacity, size_t* bytes)
+{
+    if (capacity > (SIZE_MAX - VECTOR_FILE_HEADER) / data_size) return false;
+
+    *bytes = VECTOR_FILE_HEADER + capacity * data_size;
+
+    return true;
+}
+
+/**
+ * @brief Writes a vector file: the header, then the elements. Works without
+ *        mmap, the file can be mapped wherever it ends up.
+ *
+ * @param path
+ * @param data_size
+ * @param data_type
+ * @param data
+ * @param size
+ * @return true
+ * @return false
+ */
+bool file_write(const char* path, unsigned data_size, const char* data_type, const void* data,
+                size_t size)
+{
+    unsigned char header[VECTOR_FILE_HEADER];
+    FILE* stream;
+    bool written;
+
+    if (!path || !data_size || !data_type || strlen(data_type) >= VECTOR_FILE_TYPE) return false;
+    if (size && !data) return false;
+
+    stream = fopen(path, "wb");
+    if (!stream) return false;
+
+    write_header(header, data_size, data_type, size);
+
+    written = fwrite(header, 1, sizeof(header), stream) == sizeof(header) &&
+              (!size || fwrite(data, data_size, size, stream) == size);
+
+    /* a failed close can mean the data never made it out */
+    if (fclose(stream)) written = false;
+
+    return written;
+}
+
+#ifdef VECTOR_FILE_MAP
+
+/**
+ * @brief Vector file struct.
+ *
+ */
+struct vector_file
+{
+    int fd_;
+    /* the whole file, header first */
+    unsigned char* base_;
+    size_t bytes_;
+    unsigned data_size_;
+};
+
+/**
+ * @brief Maps a whole file for reading and writing.
+ *
+ * @param fd
+ * @param bytes
+ * @return unsigned char* (NULL on failure)
+ */
+static unsigned char* map(int fd, size_t bytes)
+{
+    void* memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    return memory == MAP_FAILED ? NULL : memory;
+}
+
+/**
+ * @brief Checks a header against what the caller expects.
+ *
+ * @param fields
+ * @param bytes (the length of the file)
+ * @param data_size
+ * @param data_type (the type to expect, or receives the stored one if it's empty)
+ * @return true
+ * @return false
+ */
+static bool check_header(const file_header* fields, size_t bytes, unsigned data_size,
+                         char* data_type)
+{
+    if (memcmp(fields->magic_, file_magic, sizeof(file_magic)) ||
+        fields->version_ != FILE_VERSION || fields->endian_ != FILE_ENDIAN ||
+        fields->data_size_ != data_size)
+        return false;
+
+    /* the size has to fit in what's there */
+    if (fields->size_ > (bytes - VECTOR_FILE_HEADER) / data_size) return false;
+
+    if (!memchr(fields->type_, '\0', VECTOR_FILE_TYPE)) return false;
+
+    if (!*data_type)
+        strcpy(data_type, fields->type_);
+    else if (strcmp(data_type, fields->type_))
+        return false;
+
+    return true;
+}
+
+/**
+ * @brief Gives an empty file a header and room for capacity elements.
+ *
+ * @param file
+ * @param data_type
+ * @param capacity
+ * @param size (receives 0)
+ * @return true
+ * @return false
+ */
+static bool create_file(vector_file* file, const char* data_type, size_t capacity, size_t* size)
+{
+    /* a new file needs a type to record */
+    if (!*data_type || !file_bytes(file->data_size_, capacity, &file->bytes_)) return false;
+
+    if (ftruncate(file->fd_, (off_t)file->bytes_)) return false;
+
+    file->base_ = map(file->fd_, file->bytes_);
+    if (!file->base_) return false;
+
+    write_header(file->base_, file->data_size_, data_type, 0);
+    *size = 0;
+
+    return true;
+}
+
+/**
+ * @brief Checks the header of an existing file and maps all of it.
+ *
+ * @param file
+ * @param bytes (the length of the file)
+ * @param data_type
+ * @param size
+ * @return true
+ * @return false
+ */
+static bool open_file(vector_file* file, size_t bytes, char* data_type, size_t* size)
+{
+    file_header fields;
+
+    file->bytes_ = bytes;
+
+    if (bytes < VECTOR_FILE_HEADER ||
+        pread(file->fd_, &fields, sizeof(fields), 0) != (ssize_t)sizeof(fields) ||
+        !check_header(&fields, bytes, file->data_size_, data_type))
+        return false;
+
+    file->base_ = map(file->fd_, bytes);
+    if (!file->base_) return false;
+
+    *size = (size_t)fields.size_;
+
+    return true;
+}
+
+/**
+ * @brief Opens a vector file for reading and writing. A missing one is only
+ *        created when there's a type to give it.
+ *
+ * @param path
+ * @param data_type
+ * @param created (receives whether this call created the file)
+ * @return int (the descriptor, -1 on failure)
+ */
+static int open_path(const char* path, const char* data_type, bool* created)
+{
+    int fd = open(path, O_RDWR);
+
+    *created = false;
+
+    if (fd >= 0 || errno != ENOENT || !*data_type) return fd;
+
+    fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd >= 0)
+        *created = true;
+    else if (errno == EEXIST)
+        /* somebody else created it first */
+        fd = open(path, O_RDWR);
+
+    return fd;
+}
+
+/**
+ * @brief Maps a vector file. An empty (or new) file gets a header and room
+ *        for capacity elements, anything else is checked and mapped as is:
+ *        nothing is read but the header, so it takes the same time for any
+ *        size of file. A missing file is only created when data_type names
+ *        a type, and is removed again if it can't be set up.
+ *
+ * @param path
+ * @param data_size
+ * @param data_type (VECTOR_FILE_TYPE bytes, the type to expect, or receives
+ *                   the stored one if it's empty)
+ * @param size (receives the number of elements)
+ * @param capacity (the capacity of a new file, receives the capacity)
+ * @return vector_file* (NULL on failure, or if the file holds something else)
+ */
+vector_file* file_map(const char* path, unsigned data_size, char* data_type, size_t* size,
+                      size_t* capacity)
+{
+    vector_file* file;
+    struct stat info;
+    bool mapped, created;
+
+    if (!path || !data_size || !data_type || !size || !capacity) return NULL;
+
+    /* allocate the data */
+    file = malloc(sizeof(vector_file));
+    if (!file) return NULL;
+
+    file->data_size_ = data_size;
+    file->fd_ = open_path(path, data_type, &created);
+    if (file->fd_ < 0)
+    {
+        free(file);
+        return NULL;
+    }
+
+    if (fstat(file->fd_, &info) || (uintmax_t)info.st_size > SIZE_MAX)
+        mapped = false;
+    else if (!info.st_size)
+        mapped = create_file(file, data_type, *capacity, size);
+    else
+        mapped = open_file(file, (size_t)info.st_size, data_type, size);
+
+    if (!mapped)
+    {
+        /* don't leave a file behind that nobody asked for */
+        if (created) unlink(path);
+
+        close(file->fd_);
+        free(file);
+        return NULL;
+    }
+
+    *capacity = (file->bytes_ - VECTOR_FILE_HEADER) / data_size;
+
+    return file;
+}
+
+/**
+ * @brief Returns the mapped elements.
+ *
+ * @param file
+ * @return unsigned char*
+ */
+unsigned char* file_data(const vector_file* file)
+{
+    return file->base_ + VECTOR_FILE_HEADER;
+}
+
+/**
+ * @brief Checks if a path names the mapped file, through any link or
+ *        spelling, by comparing the device and inode.
+ *
+ * @param file
+ * @param path
+ * @return true
+ * @return false (a different file, or the path doesn't exist)
+ */
+bool file_same(const vector_file* file, const char* path)
+{
+    struct stat mapped, named;
+
+    if (fstat(file->fd_, &mapped) || stat(path, &named)) return false;
+
+    return mapped.st_dev == named.st_dev && mapped.st_ino == named.st_ino;
+}
+
+/**
+ * @brief Grows or shrinks the file, then the mapping. Linux moves the
+ *        mapping in place, elsewhere the file is mapped again.
+ *
+ * @param file
+ * @param capacity
+ * @return true
+ * @return false (the file and mapping are left as they were)
+ */
+bool file_resize(vector_file* file, size_t capacity)
+{
+    unsigned char* memory;
+    size_t bytes;
+
+    if (!file_bytes(file->data_size_, capacity, &bytes)) return false;
+    if (bytes == file->bytes_) return true;
+
+    /* the file has to be there before it's mapped */
+    if (bytes > file->bytes_ && ftruncate(file->fd_, (off_t)bytes)) return false;
+
+#ifdef MREMAP_MAYMOVE
+    memory = mremap(file->base_, file->bytes_, bytes, MREMAP_MAYMOVE);
+    if (memory == MAP_FAILED) memory = NULL;
+#else
+    memory = map(file->fd_, bytes);
+    if (memory) munmap(file->base_, file->bytes_);
+#endif
+
+    /* a grown file that couldn't be mapped just has a zeroed tail, reopening
+       it counts that as spare capacity */
+    if (!memory) return false;
+
+    /* nothing is mapped past the new end anymore. Failing to cut the file
+       short is ignored on purpose: the mapping already shrank, and the tail
+       is spare capacity the next time it's opened */
+    if (bytes < file->bytes_)
+    {
+        int ignored = ftruncate(file->fd_, (off_t)bytes);
+        (void)ignored;
+    }
+
+    file->base_ = memory;
+    file->bytes_ = bytes;
+
+    return true;
+}
+
+/**
+ * @brief Records the size in the header, then lets go of the file. The
+ *        elements were written through the mapping all along.
+ *
+ * @param file
+ * @param size
+ */
+void file_unmap(vector_file** file, size_t size)
+{
+    uint64_t stored = size;
+
+    if (file && *file)
+    {
+        memcpy((*file)->base_ + offsetof(file_header, size_), &stored, sizeof(stored));
+
+        munmap((*file)->base_, (*file)->bytes_);
+        close((*file)->fd_);
+        free(*file);
+        *file = NULL;
+    }
+}
+
+#else
+
+/* no mmap, vector_map_file always fails */
+
+vector_file* file_map(const char* path, unsigned data_size, char* data_type, size_t* size,
+                      size_t* capacity)
+{
+    (void)path; (void)data_size; (void)data_type; (void)size; (void)capacity;
+    return NULL;
+}
+
+unsigned char* file_data(const vector_file* file)
+{
+    (void)file;
+    return NULL;
+}
+
+bool file_same(const vector_file* file, const char* path)
+{
+    (void)file; (void)path;
+    return false;
+}
+
+bool file_resize(vector_file* file, size_t capacity)
+{
+    (void)file; (void)capacity;
+    return false;
+}
+
+void file_unmap(vector_file** file, size_t size)
+{
+    (void)file; (void)size;
+}
+
+#endif
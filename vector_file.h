@@ -0,0 +1,37 @@
+/******************************************************************************/
+/*
+* @file   vector_file.h
+* @author Aditya Harsh
+* @brief  Vector files. A fixed header describing the elements, followed by
+*         the elements themselves, so a file can be mapped and used as is.
+*/
+/******************************************************************************/
+
+#pragma once
+
+#include "vector.h"  /* bool   */
+#include <stddef.h>  /* size_t */
+
+/* the elements start this many bytes into the file (keeps them aligned) */
+#define VECTOR_FILE_HEADER 128
+/* the longest type name a file can hold, terminator included */
+#define VECTOR_FILE_TYPE 64
+
+/* opaque struct pointer */
+typedef struct vector_file vector_file;
+
+/* maps a vector file, creating it with room for capacity elements if it's empty
+   (data_type holds the type to expect, or receives the stored one if it's empty) */
+vector_file* file_map(const char* path, unsigned data_size, char* data_type, size_t* size,
+                      size_t* capacity);
+/* the mapped elements */
+unsigned char* file_data(const vector_file* file);
+/* checks if a path names the mapped file (compares the device and inode) */
+bool file_same(const vector_file* file, const char* path);
+/* grows or shrinks the file to hold capacity elements, the elements may move */
+bool file_resize(vector_file* file, size_t capacity);
+/* records the size in the header, then unmaps and closes the file */
+void file_unmap(vector_file** file, size_t size);
+/* writes a vector file in one go */
+bool file_write(const char* path, unsigned data_size, const char* data_type, const void* data,
+                size_t size);
@@ -0,0 +1,902 @@
+/******************************************************************************/
+/*
+* @file   vector_simd.c
+* @author Aditya Harsh
+* @brief  Search, count, min/max and sum kernels over a contiguous run of
+*         1, 2, 4 or 8 byte elements. Picks AVX2, SSE2 or plain C at runtime.
+*/
+/******************************************************************************/
+
+#include "vector_simd.h" /* kernel interface     */
+#include <string.h>      /* memcpy, memcmp       */
+#include <stdint.h>      /* fixed width integers */
+
+/* x86 kernels, the rest of the world gets the scalar loops */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+/* kernels are written once and inlined with the element size as a constant */
+#define KERNEL __attribute__((always_inline)) static __inline__
+#endif
+
+/**
+ * @brief Checks if elements of a size can be read as a kind of number.
+ *
+ * @param size
+ * @param kind
+ * @return true
+ * @return false
+ */
+static bool numeric(unsigned size, vector_kind kind)
+{
+    if (kind == VECTOR_FLOAT) return size == 4 || size == 8;
+
+    return size == 1 || size == 2 || size == 4 || size == 8;
+}
+
+/**
+ * @brief Reads an integer element, sign extended for signed kinds.
+ *
+ * @param p
+ * @param size
+ * @param kind
+ * @return uint64_t
+ */
+static uint64_t load_integer(const unsigned char* p, unsigned size, vector_kind kind)
+{
+    uint8_t b;
+    uint16_t h;
+    uint32_t w;
+    uint64_t d;
+
+    switch (size)
+    {
+    case 1:
+        memcpy(&b, p, 1);
+        return kind == VECTOR_SIGNED ? (uint64_t)(int64_t)(int8_t)b : b;
+    case 2:
+        memcpy(&h, p, 2);
+        return kind == VECTOR_SIGNED ? (uint64_t)(int64_t)(int16_t)h : h;
+    case 4:
+        memcpy(&w, p, 4);
+        return kind == VECTOR_SIGNED ? (uint64_t)(int64_t)(int32_t)w : w;
+    default:
+        memcpy(&d, p, 8);
+        return d;
+    }
+}
+
+/**
+ * @brief Reads a floating point element.
+ *
+ * @param p
+ * @param size
+ * @return double
+ */
+static double load_real(const unsigned char* p, unsigned size)
+{
+    float f;
+    double d;
+
+    if (size == 4)
+    {
+        memcpy(&f, p, 4);
+        return f;
+    }
+
+    memcpy(&d, p, 8);
+    return d;
+}
+
+/**
+ * @brief Compares two elements.
+ *
+ * @param a
+ * @param b
+ * @param size
+ * @param kind
+ * @return true (a < b)
+ * @return false
+ */
+static bool less(const unsigned char* a, const unsigned char* b, unsigned size, vector_kind kind)
+{
+    switch (kind)
+    {
+    case VECTOR_FLOAT:
+        return load_real(a, size) < load_real(b, size);
+    case VECTOR_SIGNED:
+        return (int64_t)load_integer(a, size, kind) < (int64_t)load_integer(b, size, kind);
+    default:
+        return load_integer(a, size, kind) < load_integer(b, size, kind);
+    }
+}
+
+/**
+ * @brief Scans for elements equal to key, one at a time.
+ *
+ * @param data
+ * @param first
+ * @param count
+ * @param size
+ * @param key
+ * @param matches (NULL stops at the first match)
+ * @return size_t (the first match, or count)
+ */
+static size_t scan_scalar(const unsigned char* data, size_t first, size_t count, unsigned size,
+                          const void* key, size_t* matches)
+{
+    for (; first < count; ++first)
+    {
+        if (memcmp(data + first * size, key, size)) continue;
+        if (!matches) return first;
+        ++*matches;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Folds elements into a running min and max, one at a time.
+ *
+ * @param data
+ * @param count
+ * @param size
+ * @param kind
+ * @param min (holds the smallest element so far)
+ * @param max (holds the largest element so far)
+ */
+static void min_max_scalar(const unsigned char* data, size_t count, unsigned size,
+                           vector_kind kind, unsigned char* min, unsigned char* max)
+{
+    for (; count; --count, data += size)
+    {
+        if (less(data, min, size, kind)) memcpy(min, data, size);
+        if (less(max, data, size, kind)) memcpy(max, data, size);
+    }
+}
+
+/**
+ * @brief Adds elements to a running sum, one at a time. Integers wrap
+ *        around at 64 bits.
+ *
+ * @param data
+ * @param count
+ * @param size
+ * @param kind
+ * @param total
+ * @param real
+ */
+static void sum_scalar(const unsigned char* data, size_t count, unsigned size, vector_kind kind,
+                       uint64_t* total, double* real)
+{
+    for (; count; --count, data += size)
+    {
+        if (kind == VECTOR_FLOAT)
+            *real += load_real(data, size);
+        else
+            *total += load_integer(data, size, kind);
+    }
+}
+
+#ifdef SIMD_X86
+
+/**
+ * @brief Broadcasts an element to every lane.
+ *
+ */
+TARGET_AVX2 KERNEL __m256i splat_avx2(const void* key, unsigned size)
+{
+    uint8_t b;
+    uint16_t h;
+    uint32_t w;
+    uint64_t d;
+
+    switch (size)
+    {
+    case 1: memcpy(&b, key, 1); return _mm256_set1_epi8((char)b);
+    case 2: memcpy(&h, key, 2); return _mm256_set1_epi16((short)h);
+    case 4: memcpy(&w, key, 4); return _mm256_set1_epi32((int)w);
+    default: memcpy(&d, key, 8); return _mm256_set1_epi64x((long long)d);
+    }
+}
+
+/**
+ * @brief Lanes of a equal to lanes of b.
+ *
+ */
+TARGET_AVX2 KERNEL __m256i equal_avx2(__m256i a, __m256i b, unsigned size)
+{
+    switch (size)
+    {
+    case 1: return _mm256_cmpeq_epi8(a, b);
+    case 2: return _mm256_cmpeq_epi16(a, b);
+    case 4: return _mm256_cmpeq_epi32(a, b);
+    default: return _mm256_cmpeq_epi64(a, b);
+    }
+}
+
+/**
+ * @brief Lanes of a greater than lanes of b (signed).
+ *
+ */
+TARGET_AVX2 KERNEL __m256i greater_avx2(__m256i a, __m256i b, unsigned size)
+{
+    switch (size)
+    {
+    case 1: return _mm256_cmpgt_epi8(a, b);
+    case 2: return _mm256_cmpgt_epi16(a, b);
+    case 4: return _mm256_cmpgt_epi32(a, b);
+    default: return _mm256_cmpgt_epi64(a, b);
+    }
+}
+
+/**
+ * @brief The sign bit of every lane. Flipping it makes unsigned lanes
+ *        compare correctly as signed ones.
+ *
+ */
+TARGET_AVX2 KERNEL __m256i sign_avx2(unsigned size)
+{
+    switch (size)
+    {
+    case 1: return _mm256_set1_epi8((char)0x80);
+    case 2: return _mm256_set1_epi16((short)0x8000);
+    case 4: return _mm256_set1_epi32((int)0x80000000u);
+    default: return _mm256_set1_epi64x((long long)0x8000000000000000ull);
+    }
+}
+
+/**
+ * @brief Scans 32 bytes at a time for elements equal to key.
+ *
+ */
+TARGET_AVX2 KERNEL size_t scan_avx2(const unsigned char* data, size_t count, unsigned size,
+                                    const void* key, size_t* matches)
+{
+    const __m256i needle = splat_avx2(key, size);
+    const size_t bytes = count * size;
+    size_t i;
+    unsigned mask;
+
+    for (i = 0; i + 32 <= bytes; i += 32)
+    {
+        mask = (unsigned)_mm256_movemask_epi8(
+            equal_avx2(_mm256_loadu_si256((const __m256i*)(data + i)), needle, size));
+        if (!mask) continue;
+
+        /* a matching element sets size bits in the mask */
+        if (!matches) return (i + (unsigned)__builtin_ctz(mask)) / size;
+        *matches += (unsigned)__builtin_popcount(mask) / size;
+    }
+
+    return scan_scalar(data, i / size, count, size, key, matches);
+}
+
+/**
+ * @brief Folds 32 bytes at a time into lane wise minimums and maximums.
+ *
+ */
+TARGET_AVX2 KERNEL void min_max_avx2(const unsigned char* data, size_t count, unsigned size,
+                                     vector_kind kind, unsigned char* min, unsigned char* max)
+{
+    const size_t bytes = count * size;
+    unsigned char lanes[2][32];
+    __m256i lo, hi, v, sign;
+    __m256 flo, fhi, f;
+    __m256d dlo, dhi, d;
+    size_t i = 32;
+
+    if (bytes < 32)
+    {
+        min_max_scalar(data, count, size, kind, min, max);
+        return;
+    }
+
+    if (kind == VECTOR_FLOAT && size == 4)
+    {
+        flo = fhi = _mm256_loadu_ps((const float*)data);
+        for (; i + 32 <= bytes; i += 32)
+        {
+            f = _mm256_loadu_ps((const float*)(data + i));
+            flo = _mm256_min_ps(flo, f);
+            fhi = _mm256_max_ps(fhi, f);
+        }
+        _mm256_storeu_ps((float*)lanes[0], flo);
+        _mm256_storeu_ps((float*)lanes[1], fhi);
+    }
+    else if (kind == VECTOR_FLOAT)
+    {
+        dlo = dhi = _mm256_loadu_pd((const double*)data);
+        for (; i + 32 <= bytes; i += 32)
+        {
+            d = _mm256_loadu_pd((const double*)(data + i));
+            dlo = _mm256_min_pd(dlo, d);
+            dhi = _mm256_max_pd(dhi, d);
+        }
+        _mm256_storeu_pd((double*)lanes[0], dlo);
+        _mm256_storeu_pd((double*)lanes[1], dhi);
+    }
+    else
+    {
+        sign = kind == VECTOR_UNSIGNED ? sign_avx2(size) : _mm256_setzero_si256();
+        lo = hi = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)data), sign);
+        for (; i + 32 <= bytes; i += 32)
+        {
+            v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i)), sign);
+            lo = _mm256_blendv_epi8(lo, v, greater_avx2(lo, v, size));
+            hi = _mm256_blendv_epi8(hi, v, greater_avx2(v, hi, size));
+        }
+        _mm256_storeu_si256((__m256i*)lanes[0], _mm256_xor_si256(lo, sign));
+        _mm256_storeu_si256((__m256i*)lanes[1], _mm256_xor_si256(hi, sign));
+    }
+
+    /* every lane holds a real element, fold them together with the tail */
+    min_max_scalar(lanes[0], 32 / size, size, kind, min, max);
+    min_max_scalar(lanes[1], 32 / size, size, kind, min, max);
+    min_max_scalar(data + i, (bytes - i) / size, size, kind, min, max);
+}
+
+/**
+ * @brief Sums 32 bytes at a time into 64 bit lanes.
+ *
+ */
+TARGET_AVX2 KERNEL void sum_avx2(const unsigned char* data, size_t count, unsigned size,
+                                 vector_kind kind, uint64_t* total, double* real)
+{
+    const size_t bytes = count * size;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero, v;
+    __m256d racc = _mm256_setzero_pd();
+    __m256 f;
+    uint64_t lanes[4];
+    double rlanes[4];
+    size_t i;
+
+    for (i = 0; i + 32 <= bytes; i += 32)
+    {
+        if (kind == VECTOR_FLOAT)
+        {
+            if (size == 4)
+            {
+                f = _mm256_loadu_ps((const float*)(data + i));
+                racc = _mm256_add_pd(racc, _mm256_cvtps_pd(_mm256_castps256_ps128(f)));
+                racc = _mm256_add_pd(racc, _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)));
+            }
+            else
+            {
+                racc = _mm256_add_pd(racc, _mm256_loadu_pd((const double*)(data + i)));
+            }
+            continue;
+        }
+
+        v = _mm256_loadu_si256((const __m256i*)(data + i));
+
+        switch (size)
+        {
+        case 1:
+            /* signed bytes are biased by 128 so they can be summed unsigned */
+            if (kind == VECTOR_SIGNED) v = _mm256_xor_si256(v, sign_avx2(1));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+            break;
+        case 2:
+            /* unsigned halves are biased by 32768 so they can be summed signed */
+            if (kind == VECTOR_UNSIGNED) v = _mm256_xor_si256(v, sign_avx2(2));
+            v = _mm256_madd_epi16(v, _mm256_set1_epi16(1));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+            break;
+        case 4:
+            if (kind == VECTOR_SIGNED)
+            {
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+            }
+            else
+            {
+                acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+            }
+            break;
+        default:
+            acc = _mm256_add_epi64(acc, v);
+            break;
+        }
+    }
+
+    if (kind == VECTOR_FLOAT)
+    {
+        _mm256_storeu_pd(rlanes, racc);
+        *real += (rlanes[0] + rlanes[1]) + (rlanes[2] + rlanes[3]);
+    }
+    else
+    {
+        _mm256_storeu_si256((__m256i*)lanes, acc);
+        *total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+        /* take the bias back out */
+        if (size == 1 && kind == VECTOR_SIGNED) *total -= (uint64_t)128 * (i / size);
+        if (size == 2 && kind == VECTOR_UNSIGNED) *total += (uint64_t)32768 * (i / size);
+    }
+
+    sum_scalar(data + i, (bytes - i) / size, size, kind, total, real);
+}
+
+/**
+ * @brief Broadcasts an element to every lane.
+ *
+ */
+TARGET_SSE2 KERNEL __m128i splat_sse2(const void* key, unsigned size)
+{
+    uint8_t b;
+    uint16_t h;
+    uint32_t w;
+    uint64_t d;
+
+    switch (size)
+    {
+    case 1: memcpy(&b, key, 1); return _mm_set1_epi8((char)b);
+    case 2: memcpy(&h, key, 2); return _mm_set1_epi16((short)h);
+    case 4: memcpy(&w, key, 4); return _mm_set1_epi32((int)w);
+    default: memcpy(&d, key, 8); return _mm_set1_epi64x((long long)d);
+    }
+}
+
+/**
+ * @brief Lanes of a equal to lanes of b. 64 bit lanes are equal when both
+ *        of their halves are.
+ *
+ */
+TARGET_SSE2 KERNEL __m128i equal_sse2(__m128i a, __m128i b, unsigned size)
+{
+    __m128i e;
+
+    switch (size)
+    {
+    case 1: return _mm_cmpeq_epi8(a, b);
+    case 2: return _mm_cmpeq_epi16(a, b);
+    case 4: return _mm_cmpeq_epi32(a, b);
+    default:
+        e = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+}
+
+/**
+ * @brief Lanes of a greater than lanes of b (signed, up to 32 bits).
+ *
+ */
+TARGET_SSE2 KERNEL __m128i greater_sse2(__m128i a, __m128i b, unsigned size)
+{
+    switch (size)
+    {
+    case 1: return _mm_cmpgt_epi8(a, b);
+    case 2: return _mm_cmpgt_epi16(a, b);
+    default: return _mm_cmpgt_epi32(a, b);
+    }
+}
+
+/**
+ * @brief The sign bit of every lane.
+ *
+ */
+TARGET_SSE2 KERNEL __m128i sign_sse2(unsigned size)
+{
+    switch (size)
+    {
+    case 1: return _mm_set1_epi8((char)0x80);
+    case 2: return _mm_set1_epi16((short)0x8000);
+    default: return _mm_set1_epi32((int)0x80000000u);
+    }
+}
+
+/**
+ * @brief Picks lanes of a where mask is set, lanes of b elsewhere.
+ *
+ */
+TARGET_SSE2 KERNEL __m128i select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * @brief Sign extends four 32 bit lanes into the 64 bit accumulator.
+ *
+ */
+TARGET_SSE2 KERNEL __m128i widen_sse2(__m128i acc, __m128i v, bool is_signed)
+{
+    const __m128i high = is_signed ? _mm_cmpgt_epi32(_mm_setzero_si128(), v)
+                                   : _mm_setzero_si128();
+
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, high));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, high));
+}
+
+/**
+ * @brief Scans 16 bytes at a time for elements equal to key.
+ *
+ */
+TARGET_SSE2 KERNEL size_t scan_sse2(const unsigned char* data, size_t count, unsigned size,
+                                    const void* key, size_t* matches)
+{
+    const __m128i needle = splat_sse2(key, size);
+    const size_t bytes = count * size;
+    size_t i;
+    unsigned mask;
+
+    for (i = 0; i + 16 <= bytes; i += 16)
+    {
+        mask = (unsigned)_mm_movemask_epi8(
+            equal_sse2(_mm_loadu_si128((const __m128i*)(data + i)), needle, size));
+        if (!mask) continue;
+
+        if (!matches) return (i + (unsigned)__builtin_ctz(mask)) / size;
+        *matches += (unsigned)__builtin_popcount(mask) / size;
+    }
+
+    return scan_scalar(data, i / size, count, size, key, matches);
+}
+
+/**
+ * @brief Folds 16 bytes at a time into lane wise minimums and maximums.
+ *        SSE2 can't compare 64 bit integers, those stay scalar.
+ *
+ */
+TARGET_SSE2 KERNEL void min_max_sse2(const unsigned char* data, size_t count, unsigned size,
+                                     vector_kind kind, unsigned char* min, unsigned char* max)
+{
+    const size_t bytes = count * size;
+    unsigned char lanes[2][16];
+    __m128i lo, hi, v, sign;
+    __m128 flo, fhi, f;
+    __m128d dlo, dhi, d;
+    size_t i = 16;
+
+    if (bytes < 16 || (size == 8 && kind != VECTOR_FLOAT))
+    {
+        min_max_scalar(data, count, size, kind, min, max);
+        return;
+    }
+
+    if (kind == VECTOR_FLOAT && size == 4)
+    {
+        flo = fhi = _mm_loadu_ps((const float*)data);
+        for (; i + 16 <= bytes; i += 16)
+        {
+            f = _mm_loadu_ps((const float*)(data + i));
+            flo = _mm_min_ps(flo, f);
+            fhi = _mm_max_ps(fhi, f);
+        }
+        _mm_storeu_ps((float*)lanes[0], flo);
+        _mm_storeu_ps((float*)lanes[1], fhi);
+    }
+    else if (kind == VECTOR_FLOAT)
+    {
+        dlo = dhi = _mm_loadu_pd((const double*)data);
+        for (; i + 16 <= bytes; i += 16)
+        {
+            d = _mm_loadu_pd((const double*)(data + i));
+            dlo = _mm_min_pd(dlo, d);
+            dhi = _mm_max_pd(dhi, d);
+        }
+        _mm_storeu_pd((double*)lanes[0], dlo);
+        _mm_storeu_pd((double*)lanes[1], dhi);
+    }
+    else
+    {
+        sign = kind == VECTOR_UNSIGNED ? sign_sse2(size) : _mm_setzero_si128();
+        lo = hi = _mm_xor_si128(_mm_loadu_si128((const __m128i*)data), sign);
+        for (; i + 16 <= bytes; i += 16)
+        {
+            v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data + i)), sign);
+            lo = select_sse2(greater_sse2(lo, v, size), v, lo);
+            hi = select_sse2(greater_sse2(v, hi, size), v, hi);
+        }
+        _mm_storeu_si128((__m128i*)lanes[0], _mm_xor_si128(lo, sign));
+        _mm_storeu_si128((__m128i*)lanes[1], _mm_xor_si128(hi, sign));
+    }
+
+    min_max_scalar(lanes[0], 16 / size, size, kind, min, max);
+    min_max_scalar(lanes[1], 16 / size, size, kind, min, max);
+    min_max_scalar(data + i, (bytes - i) / size, size, kind, min, max);
+}
+
+/**
+ * @brief Sums 16 bytes at a time into 64 bit lanes.
+ *
+ */
+TARGET_SSE2 KERNEL void sum_sse2(const unsigned char* data, size_t count, unsigned size,
+                                 vector_kind kind, uint64_t* total, double* real)
+{
+    const size_t bytes = count * size;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero, v;
+    __m128d racc = _mm_setzero_pd();
+    __m128 f;
+    uint64_t lanes[2];
+    double rlanes[2];
+    size_t i;
+
+    for (i = 0; i + 16 <= bytes; i += 16)
+    {
+        if (kind == VECTOR_FLOAT)
+        {
+            if (size == 4)
+            {
+                f = _mm_loadu_ps((const float*)(data + i));
+                racc = _mm_add_pd(racc, _mm_cvtps_pd(f));
+                racc = _mm_add_pd(racc, _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+            }
+            else
+            {
+                racc = _mm_add_pd(racc, _mm_loadu_pd((const double*)(data + i)));
+            }
+            continue;
+        }
+
+        v = _mm_loadu_si128((const __m128i*)(data + i));
+
+        switch (size)
+        {
+        case 1:
+            if (kind == VECTOR_SIGNED) v = _mm_xor_si128(v, sign_sse2(1));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+            break;
+        case 2:
+            if (kind == VECTOR_UNSIGNED) v = _mm_xor_si128(v, sign_sse2(2));
+            acc = widen_sse2(acc, _mm_madd_epi16(v, _mm_set1_epi16(1)), true);
+            break;
+        case 4:
+            acc = widen_sse2(acc, v, kind == VECTOR_SIGNED);
+            break;
+        default:
+            acc = _mm_add_epi64(acc, v);
+            break;
+        }
+    }
+
+    if (kind == VECTOR_FLOAT)
+    {
+        _mm_storeu_pd(rlanes, racc);
+        *real += rlanes[0] + rlanes[1];
+    }
+    else
+    {
+        _mm_storeu_si128((__m128i*)lanes, acc);
+        *total += lanes[0] + lanes[1];
+
+        if (size == 1 && kind == VECTOR_SIGNED) *total -= (uint64_t)128 * (i / size);
+        if (size == 2 && kind == VECTOR_UNSIGNED) *total += (uint64_t)32768 * (i / size);
+    }
+
+    sum_scalar(data + i, (bytes - i) / size, size, kind, total, real);
+}
+
+/* one copy of every kernel per element size */
+
+TARGET_AVX2 static size_t scan_avx2_sized(const unsigned char* data, size_t count, unsigned size,
+                                          const void* key, size_t* matches)
+{
+    switch (size)
+    {
+    case 1: return scan_avx2(data, count, 1, key, matches);
+    case 2: return scan_avx2(data, count, 2, key, matches);
+    case 4: return scan_avx2(data, count, 4, key, matches);
+    default: return scan_avx2(data, count, 8, key, matches);
+    }
+}
+
+TARGET_SSE2 static size_t scan_sse2_sized(const unsigned char* data, size_t count, unsigned size,
+                                          const void* key, size_t* matches)
+{
+    switch (size)
+    {
+    case 1: return scan_sse2(data, count, 1, key, matches);
+    case 2: return scan_sse2(data, count, 2, key, matches);
+    case 4: return scan_sse2(data, count, 4, key, matches);
+    default: return scan_sse2(data, count, 8, key, matches);
+    }
+}
+
+TARGET_AVX2 static void min_max_avx2_sized(const unsigned char* data, size_t count, unsigned size,
+                                           vector_kind kind, unsigned char* min, unsigned char* max)
+{
+    switch (size)
+    {
+    case 1: min_max_avx2(data, count, 1, kind, min, max); break;
+    case 2: min_max_avx2(data, count, 2, kind, min, max); break;
+    case 4: min_max_avx2(data, count, 4, kind, min, max); break;
+    default: min_max_avx2(data, count, 8, kind, min, max); break;
+    }
+}
+
+TARGET_SSE2 static void min_max_sse2_sized(const unsigned char* data, size_t count, unsigned size,
+                                           vector_kind kind, unsigned char* min, unsigned char* max)
+{
+    switch (size)
+    {
+    case 1: min_max_sse2(data, count, 1, kind, min, max); break;
+    case 2: min_max_sse2(data, count, 2, kind, min, max); break;
+    case 4: min_max_sse2(data, count, 4, kind, min, max); break;
+    default: min_max_sse2(data, count, 8, kind, min, max); break;
+    }
+}
+
+TARGET_AVX2 static void sum_avx2_sized(const unsigned char* data, size_t count, unsigned size,
+                                       vector_kind kind, uint64_t* total, double* real)
+{
+    switch (size)
+    {
+    case 1: sum_avx2(data, count, 1, kind, total, real); break;
+    case 2: sum_avx2(data, count, 2, kind, total, real); break;
+    case 4: sum_avx2(data, count, 4, kind, total, real); break;
+    default: sum_avx2(data, count, 8, kind, total, real); break;
+    }
+}
+
+TARGET_SSE2 static void sum_sse2_sized(const unsigned char* data, size_t count, unsigned size,
+                                       vector_kind kind, uint64_t* total, double* real)
+{
+    switch (size)
+    {
+    case 1: sum_sse2(data, count, 1, kind, total, real); break;
+    case 2: sum_sse2(data, count, 2, kind, total, real); break;
+    case 4: sum_sse2(data, count, 4, kind, total, real); break;
+    default: sum_sse2(data, count, 8, kind, total, real); break;
+    }
+}
+
+#endif
+
+/* instruction sets the kernels can use */
+#define SIMD_NONE 0
+#define SIMD_SSE2 1
+#define SIMD_AVX2 2
+
+/**
+ * @brief Picks the widest kernels the CPU runs. Only 1, 2, 4 and 8 byte
+ *        elements have kernels.
+ *
+ * @param size
+ * @return int
+ */
+static int simd_level(unsigned size)
+{
+    if (size != 1 && size != 2 && size != 4 && size != 8) return SIMD_NONE;
+
+#ifdef SIMD_X86
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+
+    return SIMD_NONE;
+}
+
+/**
+ * @brief Finds the first element equal to key.
+ *
+ * @param data
+ * @param count
+ * @param size
+ * @param key
+ * @return size_t (count if there is none)
+ */
+size_t simd_find(const void* data, size_t count, unsigned size, const void* key)
+{
+    if (!data || !count || !key) return count;
+
+    switch (simd_level(size))
+    {
+#ifdef SIMD_X86
+    case SIMD_AVX2: return scan_avx2_sized(data, count, size, key, NULL);
+    case SIMD_SSE2: return scan_sse2_sized(data, count, size, key, NULL);
+#endif
+    default: return scan_scalar(data, 0, count, size, key, NULL);
+    }
+}
+
+/**
+ * @brief Counts the elements equal to key.
+ *
+ * @param data
+ * @param count
+ * @param size
+ * @param key
+ * @return size_t
+ */
+size_t simd_count(const void* data, size_t count, unsigned size, const void* key)
+{
+    size_t matches = 0;
+
+    if (!data || !count || !key) return 0;
+
+    switch (simd_level(size))
+    {
+#ifdef SIMD_X86
+    case SIMD_AVX2: scan_avx2_sized(data, count, size, key, &matches); break;
+    case SIMD_SSE2: scan_sse2_sized(data, count, size, key, &matches); break;
+#endif
+    default: scan_scalar(data, 0, count, size, key, &matches); break;
+    }
+
+    return matches;
+}
+
+/**
+ * @brief Finds the smallest and largest element. NaNs give an unspecified
+ *        result.
+ *
+ * @param data
+ * @param count
+ * @param size
+ * @param kind
+ * @param min (may be NULL)
+ * @param max (may be NULL)
+ * @return true
+ * @return false (empty, or the elements aren't numbers of that kind)
+ */
+bool simd_min_max(const void* data, size_t count, unsigned size, vector_kind kind,
+                  void* min, void* max)
+{
+    unsigned char lo[8], hi[8];
+
+    if (!data || !count || !numeric(size, kind)) return false;
+
+    memcpy(lo, data, size);
+    memcpy(hi, data, size);
+
+    switch (simd_level(size))
+    {
+#ifdef SIMD_X86
+    case SIMD_AVX2: min_max_avx2_sized(data, count, size, kind, lo, hi); break;
+    case SIMD_SSE2: min_max_sse2_sized(data, count, size, kind, lo, hi); break;
+#endif
+    default: min_max_scalar(data, count, size, kind, lo, hi); break;
+    }
+
+    if (min) memcpy(min, lo, size);
+    if (max) memcpy(max, hi, size);
+
+    return true;
+}
+
+/**
+ * @brief Sums the elements. Integers are summed in 64 bits (wrapping around),
+ *        floating point in double precision with the lanes added separately,
+ *        so the rounding can differ from a plain loop.
+ *
+ * @param data
+ * @param count
+ * @param size
+ * @param kind
+ * @param sum (int64_t, uint64_t or double, matching the kind)
+ * @return true
+ * @return false (the elements aren't numbers of that kind)
+ */
+bool simd_sum(const void* data, size_t count, unsigned size, vector_kind kind, void* sum)
+{
+    uint64_t total = 0;
+    double real = 0;
+
+    if (!sum || !numeric(size, kind)) return false;
+
+    if (data && count)
+    {
+        switch (simd_level(size))
+        {
+#ifdef SIMD_X86
+        case SIMD_AVX2: sum_avx2_sized(data, count, size, kind, &total, &real); break;
+        case SIMD_SSE2: sum_sse2_sized(data, count, size, kind, &total, &real); break;
+#endif
+        default: sum_scalar(data, count, size, kind, &total, &real); break;
+        }
+    }
+
+    if (kind == VECTOR_FLOAT)
+        memcpy(sum, &real, sizeof(real));
+    else
+        memcpy(sum, &total, sizeof(total));
+
+    return true;
+}
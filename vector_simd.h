@@ -0,0 +1,23 @@
+/******************************************************************************/
+/*
+* @file   vector_simd.h
+* @author Aditya Harsh
+* @brief  Search, count, min/max and sum kernels over a contiguous run of
+*         1, 2, 4 or 8 byte elements. Picks AVX2, SSE2 or plain C at runtime.
+*/
+/******************************************************************************/
+
+#pragma once
+
+#include "vector.h"  /* bool, vector_kind */
+#include <stddef.h>  /* size_t             */
+
+/* index of the first element equal to key (count if there is none) */
+size_t simd_find(const void* data, size_t count, unsigned size, const void* key);
+/* number of elements equal to key */
+size_t simd_count(const void* data, size_t count, unsigned size, const void* key);
+/* smallest and largest element, either output may be NULL */
+bool simd_min_max(const void* data, size_t count, unsigned size, vector_kind kind,
+                  void* min, void* max);
+/* sum of the elements (a 64 bit integer of the same signedness, or a double) */
+bool simd_sum(const void* data, size_t count, unsigned size, vector_kind kind, void* sum);
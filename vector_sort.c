@@ -0,0 +1,338 @@
+/******************************************************************************/
+/*
+* @file   vector_sort.c
+* @author Aditya Harsh
+* @brief  LSD radix sort over a contiguous run of fixed size records, keyed
+*         on an integer or floating point field. Spreads across threads.
+*/
+/******************************************************************************/
+
+#include "vector_sort.h" /* radix sort interface */
+#include <stdlib.h>      /* malloc, free         */
+#include <string.h>      /* memcpy, memset       */
+#include <stdint.h>      /* fixed width integers */
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>     /* pthread_create, pthread_join */
+#include <unistd.h>      /* sysconf                      */
+#define SORT_THREADS
+#endif
+
+/* one byte of the key per pass */
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MAX_DIGITS 8
+/* records a thread should get before it's worth starting one */
+#define RADIX_MIN_PER_THREAD 65536
+#define RADIX_MAX_THREADS 64
+
+/**
+ * @brief The records one thread handles.
+ *
+ */
+typedef struct
+{
+    /* records [first_, last_) of src_ go to dst_ */
+    const unsigned char* src_;
+    unsigned char* dst_;
+    size_t first_;
+    size_t last_;
+
+    /* the record layout */
+    unsigned size_;
+    unsigned key_offset_;
+    unsigned key_size_;
+    vector_kind kind_;
+
+    /* the digit being sorted on, and where each bucket goes next */
+    unsigned digit_;
+    size_t offsets_[RADIX_BUCKETS];
+    /* how many of the records fall in each bucket, for every digit */
+    size_t counts_[RADIX_MAX_DIGITS][RADIX_BUCKETS];
+} radix_part;
+
+/**
+ * @brief Reads the key of a record, mapped so unsigned order is key order.
+ *
+ * @param part
+ * @param record
+ * @return uint64_t
+ */
+static uint64_t sort_key(const radix_part* part, const unsigned char* record)
+{
+    const unsigned bits = part->key_size_ * 8;
+    const uint64_t sign = (uint64_t)1 << (bits - 1);
+    const uint64_t all = sign | (sign - 1);
+    uint8_t b;
+    uint16_t h;
+    uint32_t w;
+    uint64_t k;
+
+    record += part->key_offset_;
+
+    switch (part->key_size_)
+    {
+    case 1: memcpy(&b, record, 1); k = b; break;
+    case 2: memcpy(&h, record, 2); k = h; break;
+    case 4: memcpy(&w, record, 4); k = w; break;
+    default: memcpy(&k, record, 8); break;
+    }
+
+    switch (part->kind_)
+    {
+    case VECTOR_SIGNED:
+        /* negatives first */
+        return k ^ sign;
+    case VECTOR_FLOAT:
+        /* negatives first and in reverse, positives after them */
+        return k & sign ? k ^ all : k ^ sign;
+    default:
+        return k;
+    }
+}
+
+/**
+ * @brief Counts every digit of every key in a part.
+ *
+ * @param arg (radix_part*)
+ * @return void*
+ */
+static void* count_part(void* arg)
+{
+    radix_part* part = arg;
+    const unsigned char* record = part->src_ + part->first_ * part->size_;
+    size_t i;
+    unsigned digit;
+    uint64_t key;
+
+    for (i = part->first_; i < part->last_; ++i, record += part->size_)
+    {
+        key = sort_key(part, record);
+
+        for (digit = 0; digit < part->key_size_; ++digit)
+            ++part->counts_[digit][(key >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Counts one digit of every key in a part.
+ *
+ * @param arg (radix_part*)
+ * @return void*
+ */
+static void* count_digit_part(void* arg)
+{
+    radix_part* part = arg;
+    const unsigned char* record = part->src_ + part->first_ * part->size_;
+    const unsigned shift = part->digit_ * RADIX_BITS;
+    size_t* counts = part->counts_[part->digit_];
+    size_t i;
+
+    memset(counts, 0, sizeof(part->counts_[0]));
+
+    for (i = part->first_; i < part->last_; ++i, record += part->size_)
+        ++counts[(sort_key(part, record) >> shift) & (RADIX_BUCKETS - 1)];
+
+    return NULL;
+}
+
+/**
+ * @brief Moves the records of a part into their buckets for one digit.
+ *        Written once and inlined with common record sizes as constants.
+ *
+ * @param part
+ * @param size
+ */
+static __inline__ void scatter(radix_part* part, unsigned size)
+{
+    const unsigned char* record = part->src_ + part->first_ * size;
+    const unsigned shift = part->digit_ * RADIX_BITS;
+    size_t i, bucket;
+
+    for (i = part->first_; i < part->last_; ++i, record += size)
+    {
+        bucket = (sort_key(part, record) >> shift) & (RADIX_BUCKETS - 1);
+        memcpy(part->dst_ + part->offsets_[bucket]++ * size, record, size);
+    }
+}
+
+/**
+ * @brief Moves the records of a part into their buckets for one digit.
+ *
+ * @param arg (radix_part*)
+ * @return void*
+ */
+static void* scatter_part(void* arg)
+{
+    radix_part* part = arg;
+
+    switch (part->size_)
+    {
+    case 4: scatter(part, 4); break;
+    case 8: scatter(part, 8); break;
+    case 16: scatter(part, 16); break;
+    default: scatter(part, part->size_); break;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Runs work on every part, one thread each.
+ *
+ * @param parts
+ * @param threads
+ * @param work
+ */
+static void run_parts(radix_part* parts, unsigned threads, void* (*work)(void*))
+{
+    unsigned i, started = 1;
+
+#ifdef SORT_THREADS
+    pthread_t ids[RADIX_MAX_THREADS];
+
+    for (; started < threads; ++started)
+        if (pthread_create(ids + started, NULL, work, parts + started)) break;
+#endif
+
+    work(parts);
+
+    /* whatever didn't get a thread runs here */
+    for (i = started; i < threads; ++i)
+        work(parts + i);
+
+#ifdef SORT_THREADS
+    for (i = 1; i < started; ++i)
+        pthread_join(ids[i], NULL);
+#endif
+}
+
+/**
+ * @brief Picks how many threads to sort with.
+ *
+ * @param count
+ * @param threads (0 = one per processor)
+ * @return unsigned
+ */
+static unsigned pick_threads(size_t count, unsigned threads)
+{
+#ifdef SORT_THREADS
+    long processors;
+
+    if (!threads)
+    {
+        processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = processors > 0 ? (unsigned)processors : 1;
+    }
+#else
+    threads = 1;
+#endif
+
+    if (threads > RADIX_MAX_THREADS)
+        threads = RADIX_MAX_THREADS;
+    if (threads > count / RADIX_MIN_PER_THREAD)
+        threads = (unsigned)(count / RADIX_MIN_PER_THREAD);
+
+    return threads ? threads : 1;
+}
+
+/**
+ * @brief Sorts records by an integer or floating point key. Stable. Each pass
+ *        splits the records between threads; every thread owns a slice of
+ *        each bucket, so they scatter without sharing anything. The first
+ *        read counts every digit, later passes only recount when threaded.
+ *
+ * @param data
+ * @param scratch (room for count records)
+ * @param count
+ * @param size
+ * @param key_offset
+ * @param key_size (1, 2, 4 or 8 bytes, 4 or 8 for VECTOR_FLOAT)
+ * @param kind
+ * @param threads (0 = one per processor)
+ * @return void* (data or scratch, NULL on failure)
+ */
+void* radix_sort(void* data, void* scratch, size_t count, unsigned size, unsigned key_offset,
+                 unsigned key_size, vector_kind kind, unsigned threads)
+{
+    radix_part* parts;
+    unsigned char* src = data;
+    unsigned char* dst = scratch;
+    unsigned char* temp;
+    unsigned t, digit, bucket;
+    size_t chunk, running;
+    bool moved = false;
+
+    if (!data || !scratch) return NULL;
+    if (key_size != 1 && key_size != 2 && key_size != 4 && key_size != 8) return NULL;
+    if (kind == VECTOR_FLOAT && key_size != 4 && key_size != 8) return NULL;
+    if (key_offset + key_size > size) return NULL;
+
+    threads = pick_threads(count, threads);
+    parts = malloc(sizeof(radix_part) * threads);
+    if (!parts) return NULL;
+
+    chunk = count / threads;
+
+    for (t = 0; t < threads; ++t)
+    {
+        parts[t].src_ = src;
+        parts[t].first_ = chunk * t;
+        parts[t].last_ = t + 1 == threads ? count : chunk * (t + 1);
+        parts[t].size_ = size;
+        parts[t].key_offset_ = key_offset;
+        parts[t].key_size_ = key_size;
+        parts[t].kind_ = kind;
+        memset(parts[t].counts_, 0, sizeof(parts[t].counts_));
+    }
+
+    /* one read pass counts every digit */
+    run_parts(parts, threads, count_part);
+
+    for (digit = 0; digit < key_size; ++digit)
+    {
+        /* skip digits every key shares */
+        for (bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            for (running = 0, t = 0; t < threads; ++t)
+                running += parts[t].counts_[digit][bucket];
+            if (running) break;
+        }
+        if (running == count) continue;
+
+        for (t = 0; t < threads; ++t)
+        {
+            parts[t].src_ = src;
+            parts[t].dst_ = dst;
+            parts[t].digit_ = digit;
+        }
+
+        /* after a pass the slices hold other records, count them again */
+        if (threads > 1 && moved)
+            run_parts(parts, threads, count_digit_part);
+
+        /* bucket by bucket, thread by thread, so the sort stays stable */
+        running = 0;
+        for (bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            for (t = 0; t < threads; ++t)
+            {
+                parts[t].offsets_[bucket] = running;
+                running += parts[t].counts_[digit][bucket];
+            }
+        }
+
+        run_parts(parts, threads, scatter_part);
+        moved = true;
+
+        temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    free(parts);
+
+    return src;
+}
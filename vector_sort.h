@@ -0,0 +1,18 @@
+/******************************************************************************/
+/*
+* @file   vector_sort.h
+* @author Aditya Harsh
+* @brief  LSD radix sort over a contiguous run of fixed size records, keyed
+*         on an integer or floating point field. Spreads across threads.
+*/
+/******************************************************************************/
+
+#pragma once
+
+#include "vector.h"  /* vector_kind */
+#include <stddef.h>  /* size_t      */
+
+/* sorts records by the key at key_offset, returns data or scratch, whichever
+   ends up holding the result (NULL on failure) */
+void* radix_sort(void* data, void* scratch, size_t count, unsigned size, unsigned key_offset,
+                 unsigned key_size, vector_kind kind, unsigned threads);